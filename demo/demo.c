@@ -1,9 +1,22 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <uuid/uuid.h>
 
 #include "like.h"
 #include "bn512.h"
 
+// Stop the demo at the first step which does not return LIKE_OK
+#define CHECK(call) \
+    do \
+    { \
+        int rc = (call); \
+        if(rc != LIKE_OK) \
+        { \
+            fprintf(stderr, "\n%s failed with status %d\n", #call, rc); \
+            return EXIT_FAILURE; \
+        } \
+    } while(0)
+
 int main()
 {
 
@@ -14,13 +27,12 @@ int main()
      * *****************************************************************/
 
     // General Param
-    mclBnG1 P, xP;
-    mclBnG2 Q, xQ, yQ;
+    mclBnG1 P;
+    mclBnG2 Q;
     mclBnFr x, y; 
-    XY_ni x_ni, y_ni;
-    mclBnGT ka, kb, k, l1_T1, l2_T1;
+    LikeSession session;
+    mclBnGT ka, kb, k;
     SST sst;
-    Lambda_eq_ni l1_T2, l2_T2;
 
     // Id
     size_t id_len = sizeof(uuid_t);
@@ -39,9 +51,17 @@ int main()
     char priv_key_B[] = "keys/b_priv_key.pem";
     char pub_key_O[] = "keys/o_pub_key.pem";
     char priv_key_O[] = "keys/o_priv_key.pem";
-    mclBnG1 L1_pk, L2_pk, L_pk;
-    mclBnFr l1_sk, l2_sk;
-    Lambda_ni l1_ni, l2_ni;
+    Ed25519Key sk_A, pk_A, sk_B, pk_B, sk_O, pk_O;
+    char key_cache_path[] = "keys/verified_keys.cache";
+    KeyCache key_cache;
+    VerifyStats stats;
+    size_t nb_authorities = 2;
+    AggregateKey L_pk;
+    mclBnG1 Li_pk[nb_authorities];
+    mclBnFr li_sk[nb_authorities];
+    Lambda_ni li_ni[nb_authorities];
+    mclBnGT li_T1[nb_authorities];
+    Lambda_eq_ni li_T2[nb_authorities];
 
     // Sig buffer
     size_t sig_len = ED25519_SIG_LENGTH;
@@ -57,24 +77,32 @@ int main()
 
     // Setup
     printf("Set up pairing... ");
-    setup(&P, &Q);
+    CHECK(setup(&P, &Q));
     printf("Done\n");
 
     printf("Key gen... ");
     //UKeyGen A
-    u_o_key_gen(pub_key_A, priv_key_A);
+    CHECK(u_o_key_gen(pub_key_A, priv_key_A));
 
     // UKeyGen B
-    u_o_key_gen(pub_key_B, priv_key_B);
+    CHECK(u_o_key_gen(pub_key_B, priv_key_B));
 
     // UKeyGen O
-    u_o_key_gen(pub_key_O, priv_key_O);
-
-    // LambdaKeyGen L1
-    a_key_gen(&P, &l1_sk, &L1_pk, &l1_ni);
-
-    // LambdaKeyGen L2
-    a_key_gen(&P, &l2_sk, &L2_pk, &l2_ni);
+    CHECK(u_o_key_gen(pub_key_O, priv_key_O));
+
+    // Each key is read from its file once, then used by all the signatures
+    CHECK(ed25519_key_load_priv(&sk_A, priv_key_A));
+    CHECK(ed25519_key_load_pub(&pk_A, pub_key_A));
+    CHECK(ed25519_key_load_priv(&sk_B, priv_key_B));
+    CHECK(ed25519_key_load_pub(&pk_B, pub_key_B));
+    CHECK(ed25519_key_load_priv(&sk_O, priv_key_O));
+    CHECK(ed25519_key_load_pub(&pk_O, pub_key_O));
+
+    // LambdaKeyGen L1, L2
+    for(size_t i = 0; i < nb_authorities; i++)
+    {
+        CHECK(a_key_gen(POK_FORMAT_COMMIT, &P, &li_sk[i], &Li_pk[i], &li_ni[i]));
+    }
     printf("Done\n");
 
     /*******************************************************************
@@ -86,9 +114,14 @@ int main()
     // *********************** AKE Precal ***********************
 
     printf("Ake pre-computations... ");
-    verify_L_ni(&P, 4, &L1_pk, &l1_ni, &L2_pk, &l2_ni);
-    ake_precalc_add_lipk(&L_pk, 2, &L1_pk, &L2_pk);
+    // Authority set epoch 1, the cached proofs are dropped when it changes
+    CHECK(key_cache_open(&key_cache, key_cache_path, 1));
+    CHECK(verify_L_ni_cached(&key_cache, &P, nb_authorities, Li_pk, li_ni));
+    aggregate_key_init(&L_pk, nb_authorities, Li_pk);
+    CHECK(aggregate_key_sync(&L_pk));
     ake_precalc_get_omega(omega, 8, id_A, id_len, id_B, id_len, id_L1, id_len, id_L2, id_len);
+    CHECK(like_session_init(&session, LIKE_SIG_TRANSCRIPT, omega, omega_len, sig_len));
+    verify_stats_init(&stats);
     printf("Done\n");
 
 
@@ -96,41 +129,37 @@ int main()
 
     printf("Ake... ");
     // A : ake_a_get_mx
-    ake_a_get_mx(&P, &Q, &x, omega, omega_len, &xP, &xQ, &x_ni);
+    CHECK(ake_a_get_mx(POK_FORMAT_COMMIT, &P, &Q, &x, omega, omega_len, &session.xP, &session.xQ, &session.x_ni, NULL));
  
-    // O : verify_mx
-    verify_mx(&P, &xP, &Q, &xQ, omega, omega_len, &x_ni);
-
     // B : ake_b_get_my, verify_mx, ake_b_get_sigma_Y_1
-    ake_b_get_my(&Q, &y, omega, omega_len, &yQ, &y_ni);
-    verify_mx(&P, &xP, &Q, &xQ, omega, omega_len, &x_ni);
-    ake_b_get_sigma_Y_1(priv_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
+    CHECK(ake_b_get_my(POK_FORMAT_COMMIT, &Q, &y, omega, omega_len, &session.yQ, &session.y_ni));
+    CHECK(verify_mx(&P, &Q, &session, NULL));
+    CHECK(ake_b_get_sigma_Y_1(&sk_B, &session, sigma_Y_1));
 
-    // O : verify_my, verify_sigma_Y_1
-    verify_my(&Q, &yQ, omega, omega_len, &y_ni);
-    verify_sigma_Y_1(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
+    // O : mx, my and sigma_Y_1 checked together, cheapest checks first
+    CHECK(ake_O_verify_mxy(&stats, &pk_B, &P, &Q, &session, sigma_Y_1, NULL));
 
     // A : verify_my, verify_sigma_Y_1, ake_a_get_sigma_X
-    verify_my(&Q, &yQ, omega, omega_len, &y_ni);
-    verify_sigma_Y_1(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
-    ake_a_get_sigma_X(priv_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
+    CHECK(verify_my(&Q, &session.yQ, omega, omega_len, &session.y_ni));
+    CHECK(verify_sigma_Y_1(&pk_B, &session, sigma_Y_1));
+    CHECK(ake_a_get_sigma_X(&sk_A, &session, sigma_Y_1, sigma_X));
 
     // O : verify_sigma_X
-    verify_sigma_X(pub_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
+    CHECK(verify_sigma_X(&pk_A, &session, sigma_Y_1, sigma_X));
 
     // B : verify_sigma_X, ake_b_get_sigma_Y_2
-    verify_sigma_X(pub_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
-    ake_b_get_sigma_Y_2(priv_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
+    CHECK(verify_sigma_X(&pk_A, &session, sigma_Y_1, sigma_X));
+    CHECK(ake_b_get_sigma_Y_2(&sk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2));
 
     // A : ake_a_get_shared_key
-    ake_a_get_shared_key(&L_pk, &yQ, &x, &ka);
+    ake_a_get_shared_key(&L_pk, &session, &x, &ka);
 
     // B : ake_b_get_shared_key
-    ake_b_get_shared_key(&L_pk, &xQ, &y, &kb);
+    ake_b_get_shared_key(&L_pk, &session, &y, &kb);
 
     // O : verify_sigma_Y_2, ake_O_get_sst
-    verify_sigma_Y_2(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
-    ake_O_get_sst(priv_key_O, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, &sst);
+    CHECK(verify_sigma_Y_2(&pk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2));
+    CHECK(ake_O_get_sst(&sk_O, &session, sigma_Y_1, sigma_X, sigma_Y_2, &sst));
     printf("Done\n");
 
     /*******************************************************************
@@ -141,31 +170,31 @@ int main()
 
     // Verification
     printf("Verify_L_ni... ");
-    verify_L_ni(&P, 4, &L1_pk, &l1_ni, &L2_pk, &l2_ni);
+    CHECK(verify_L_ni(&P, nb_authorities, Li_pk, li_ni));
     printf("Done\n");
 
     printf("Verify_mx... ");
-    verify_mx(&P, &xP, &Q, &xQ, omega, omega_len, &x_ni);
+    CHECK(verify_mx(&P, &Q, &session, NULL));
     printf("Done\n");
 
     printf("Verify_my... ");
-    verify_my(&Q, &yQ, omega, omega_len, &y_ni);
+    CHECK(verify_my(&Q, &session.yQ, omega, omega_len, &session.y_ni));
     printf("Done\n");
 
     printf("Verify_sigma_Y_1... ");
-    verify_sigma_Y_1(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
+    CHECK(verify_sigma_Y_1(&pk_B, &session, sigma_Y_1));
     printf("Done\n");
 
     printf("Verify_sigma_X... ");
-    verify_sigma_X(pub_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
+    CHECK(verify_sigma_X(&pk_A, &session, sigma_Y_1, sigma_X));
     printf("Done\n");
 
     printf("Verify_sigma_Y_2... ");
-    verify_sigma_Y_2(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
+    CHECK(verify_sigma_Y_2(&pk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2));
     printf("Done\n");
 
     printf("Verify_sst... ");
-    verify_sst(pub_key_O, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, &sst);
+    CHECK(verify_sst(&pk_O, &session, sigma_Y_1, sigma_X, sigma_Y_2, &sst));
     printf("Done\n");
 
     /*******************************************************************
@@ -176,8 +205,8 @@ int main()
 
     // TDGen
     printf("Gen trapdoors... ");
-    tdgen_get_li_T1(&xP, &yQ, 4, &l1_sk, &l1_T1, &l2_sk, &l2_T1);
-    tdgen_get_li_T2(&P, &xP, &yQ, 8, &L1_pk, &l1_sk, &l1_T1, &l1_T2, &L2_pk, &l2_sk, &l2_T1, &l2_T2);
+    tdgen_get_li_T1(&session, nb_authorities, li_sk, li_T1);
+    CHECK(tdgen_get_li_T2(&P, &session, nb_authorities, Li_pk, li_sk, li_T1, li_T2));
     printf("Done\n");
 
 
@@ -189,8 +218,8 @@ int main()
 
     // Open
     printf("Recover secret... ");
-    verify_li_T2(&P, &xP, &yQ, 6, &L1_pk, &l1_T1, &l1_T2, &L2_pk, &l2_T1, &l2_T2);
-    open_get_shared_key(&k, 2, &l1_T1, &l2_T1);
+    CHECK(verify_li_T2(&P, &session, nb_authorities, Li_pk, li_T1, li_T2));
+    open_get_shared_key(&k, nb_authorities, li_T1);
     printf("Done\n");
     printf("\n");
 
@@ -231,6 +260,15 @@ int main()
     free(sigma_Y_2);
     free(sst.m);
     free(sst.sigma_O);
+    like_session_free(&session);
+    key_cache_close(&key_cache);
+    aggregate_key_free(&L_pk);
+    ed25519_key_free(&sk_A);
+    ed25519_key_free(&pk_A);
+    ed25519_key_free(&sk_B);
+    ed25519_key_free(&pk_B);
+    ed25519_key_free(&sk_O);
+    ed25519_key_free(&pk_O);
 
     return 0;
 
@@ -2,3 +2,9 @@
 
 #define MCLBN_FP_UNIT_SIZE 8
 #include <mcl/bn.h>
+
+// Upper bounds of serialized sizes, used for fixed size buffers
+#define FR_MAX_LENGTH (MCLBN_FP_UNIT_SIZE * 8)
+#define G1_MAX_LENGTH (MCLBN_FP_UNIT_SIZE * 8)
+#define G2_MAX_LENGTH (G1_MAX_LENGTH * 2)
+#define GT_MAX_LENGTH (G1_MAX_LENGTH * 12)
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "bn512.h"
+
+// Window size in bits of the generator tables built by setup()
+// Memory grows as 2^w / w, speed as 1 / w (4 : ~360 KB for P, ~720 KB for Q)
+#ifndef LIKE_FB_WINDOW
+#define LIKE_FB_WINDOW 4
+#endif
+
+typedef struct fb_G1
+{
+
+    mclBnG1 base;
+    mclBnG1 * table;
+    int window;
+    size_t nb_windows;
+
+} FB_G1;
+
+typedef struct fb_G2
+{
+
+    mclBnG2 base;
+    mclBnG2 * table;
+    int window;
+    size_t nb_windows;
+
+} FB_G2;
+
+int fb_G1_init(FB_G1 * fb, mclBnG1 * base, int window);
+
+void fb_G1_mul(mclBnG1 * z, FB_G1 * fb, mclBnFr * k);
+
+void fb_G1_free(FB_G1 * fb);
+
+size_t fb_G1_size(FB_G1 * fb);
+
+int fb_G2_init(FB_G2 * fb, mclBnG2 * base, int window);
+
+void fb_G2_mul(mclBnG2 * z, FB_G2 * fb, mclBnFr * k);
+
+void fb_G2_free(FB_G2 * fb);
+
+size_t fb_G2_size(FB_G2 * fb);
+
+int fb_init_generators(mclBnG1 * P, mclBnG2 * Q, int window);
+
+void G1_mul_gen(mclBnG1 * z, mclBnG1 * P, mclBnFr * k);
+
+void G2_mul_gen(mclBnG2 * z, mclBnG2 * Q, mclBnFr * k);
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "utils_like.h"
+
+// Length of the digests kept by the cache (sha256)
+#define KEY_CACHE_DIGEST_LENGTH 32
+
+// Number of slots of a new cache file, doubled each time it gets half full
+#ifndef LIKE_KEY_CACHE_SLOTS
+#define LIKE_KEY_CACHE_SLOTS 256
+#endif
+
+// Start of the cache file, followed by nb_slots digests, an all zero digest marks an empty slot
+typedef struct key_cache_header
+{
+
+    unsigned char magic[8];
+    uint64_t epoch;
+    uint64_t nb_slots;
+    uint64_t count;
+
+} KeyCacheHeader;
+
+// Set of the digests of the authority key proofs already verified, kept in a memory-mapped file shared under flock
+typedef struct key_cache
+{
+
+    int fd;
+    KeyCacheHeader * header; // start of the mapping, NULL if the file could not be mapped again
+    unsigned char * slots; // nb_slots digests right after the header
+    size_t map_len;
+    size_t nb_slots; // slots of this mapping, the file is mapped again when the header holds an other value
+    uint64_t epoch;
+
+} KeyCache;
+
+int key_cache_open(KeyCache * cache, char * path, uint64_t epoch);
+
+int key_cache_contains(KeyCache * cache, unsigned char * digest);
+
+int key_cache_insert(KeyCache * cache, unsigned char * digest);
+
+void key_cache_close(KeyCache * cache);
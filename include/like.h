@@ -1,13 +1,23 @@
 #pragma once
 
+#include <stdint.h>
+
+#include "pok.h"
 #include "sig.h"
 #include "bn512.h"
+#include "pairing.h"
+#include "pool.h"
+#include "fixed_base.h"
+#include "key_cache.h"
 #include "utils_like.h"
 
+// Proof formats of Lambda_ni and XY_ni, POK_FORMAT_COMMIT uses Rho, POK_FORMAT_COMPACT uses e
 typedef struct lambda_ni
 {
 
+    int format;
     mclBnG1 Rho;
+    unsigned char e[CHALLENGE_LENGTH];
     mclBnFr d;
 
 } Lambda_ni;
@@ -16,20 +26,96 @@ typedef struct lambda_ni
 typedef struct xy_ni
 {
 
+    int format;
     mclBnG2 Rho;
+    unsigned char e[CHALLENGE_LENGTH];
     mclBnFr d;
 
 } XY_ni;
 
+// Optional proof that xP and xQ share the same discrete log, checked by verify_mx instead of the pairings
+typedef struct x_eq_ni
+{
+
+    mclBnG1 Rho;
+    mclBnG2 Sigma;
+    mclBnFr d;
+
+} X_eq_ni;
+
+// Proof format produced by tdgen_get_li_T2
+#define LAMBDA_EQ_NI_VERSION EQ_NIPOK_GT_BIN
+
 typedef struct lambda_eq_ni
 {
 
+    int version;
     mclBnG1 Rho;
     mclBnGT Sigma;
     mclBnFr d;
 
 } Lambda_eq_ni;
 
+// Signing modes of the AKE messages
+#define LIKE_SIG_TRANSCRIPT 1 // each signature covers the whole transcript
+#define LIKE_SIG_CHAINED 2 // each signature covers a running sha256 digest of the transcript
+
+// Length of the running digest of LIKE_SIG_CHAINED (sha256)
+#define LIKE_DIGEST_LENGTH 32
+
+// Points of an AKE session and the transcript serialized once from them
+typedef struct like_session
+{
+
+    int sig_mode;
+    unsigned char * omega;
+    size_t omega_len;
+    mclBnG1 xP;
+    mclBnG2 xQ;
+    XY_ni x_ni;
+    mclBnG2 yQ;
+    XY_ni y_ni;
+    size_t sig_len;
+    unsigned char * transcript; // omega||xP||xQ||x_ni||yQ||y_ni||sigma_Y_1||sigma_X||sigma_Y_2
+    size_t mxy_len; // length of omega||xP||xQ||x_ni||yQ||y_ni in transcript, 0 until serialized
+    unsigned char mxy_digest[LIKE_DIGEST_LENGTH]; // H(omega||xP||xQ||x_ni||yQ||y_ni), set with mxy_len in LIKE_SIG_CHAINED
+    int has_xy_pairing;
+    mclBnGT xy_pairing; // e(xP, yQ), computed once for TDGen and Open
+    mclBnG1 xy_xP; // xP and yQ of xy_pairing, it is computed again once they no longer match the session
+    mclBnG2 xy_yQ;
+    G2_Lines xQ_lines; // Miller loop lines of xQ, computed by verify_mx and reused by ake_b_get_shared_key
+
+} LikeSession;
+
+// Aggregated authorities public key kept across sessions, updated with one point addition per change of the authority set
+// Owns the fixed-base table of L_pk used by the shared keys, freed by aggregate_key_free
+typedef struct aggregate_key
+{
+
+    mclBnG1 L_pk;
+    uint64_t epoch; // incremented at each change of the authority set
+    uint64_t table_epoch; // epoch of the fixed-base table of L_pk, 0 until aggregate_key_sync builds it
+    FB_G1 table; // fixed-base table of L_pk, built by aggregate_key_sync
+
+} AggregateKey;
+
+// Stages of ake_O_verify_mxy, in the order they run
+#define LIKE_STAGE_FORMAT 0 // lengths, proof formats and points
+#define LIKE_STAGE_SIG 1 // sigma_Y_1
+#define LIKE_STAGE_SCHNORR 2 // x_ni, y_ni and x_eq_ni
+#define LIKE_STAGE_PAIRING 3 // e(xP, Q) == e(P, xQ)
+#define LIKE_NB_STAGES 4
+
+// Counters of the messages checked by an operator and of the stage at which each rejected one failed
+typedef struct verify_stats
+{
+
+    uint64_t nb_checked;
+    uint64_t nb_accepted;
+    uint64_t nb_rejected[LIKE_NB_STAGES];
+
+} VerifyStats;
+
 typedef struct sst
 {
     unsigned char * m;
@@ -38,51 +124,85 @@ typedef struct sst
     size_t sigma_O_len;
 } SST;
 
-void setup(mclBnG1 * P, mclBnG2 * Q);
+int setup(mclBnG1 * P, mclBnG2 * Q);
 
 //void u_o_key_gen(char * pub_key_path, char * priv_key_path);
 #define u_o_key_gen sgen_ed25519
 
-void a_key_gen(mclBnG1 * P, mclBnFr * lambda_sk, mclBnG1 * lambda_pk, Lambda_ni * lambda_ni);
+int a_key_gen(int format, mclBnG1 * P, mclBnFr * lambda_sk, mclBnG1 * lambda_pk, Lambda_ni * lambda_ni);
+
+int verify_L_ni(mclBnG1 * P, size_t n, mclBnG1 * Li_pk, Lambda_ni * li_ni);
+
+int verify_L_ni_cached(KeyCache * cache, mclBnG1 * P, size_t n, mclBnG1 * Li_pk, Lambda_ni * li_ni);
+
+void ake_precalc_add_lipk(mclBnG1 * L_pk, size_t n, mclBnG1 * Li_pk);
+
+int ake_precalc_L_pk_table(FB_G1 * L_pk_table, mclBnG1 * L_pk);
+
+void aggregate_key_init(AggregateKey * agg, size_t n, mclBnG1 * Li_pk);
+
+void aggregate_key_add(AggregateKey * agg, mclBnG1 * Li_pk);
+
+void aggregate_key_remove(AggregateKey * agg, mclBnG1 * Li_pk);
+
+void aggregate_key_rotate(AggregateKey * agg, mclBnG1 * old_Li_pk, mclBnG1 * new_Li_pk);
 
-void verify_L_ni(mclBnG1 * P, int nb_args, ...);
+int aggregate_key_sync(AggregateKey * agg);
 
-void ake_precalc_add_lipk(mclBnG1 * L_pk, int nb_args, ...);
+void aggregate_key_free(AggregateKey * agg);
 
 #define ake_precalc_get_omega concat_arrays
 
-void ake_a_get_mx(mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni);
+int ake_a_get_mx(int format, mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, X_eq_ni * x_eq_ni);
+
+int ake_a_get_mx_pooled(int format, EphemeralPool * pool, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni);
+
+int verify_mx(mclBnG1 * P, mclBnG2 * Q, LikeSession * session, X_eq_ni * x_eq_ni);
+
+int ake_b_get_my(int format, mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni);
+
+int ake_b_get_my_pooled(int format, EphemeralPool * pool, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni);
+
+int verify_my(mclBnG2 * Q, mclBnG2 * yQ, unsigned char * omega, size_t omega_len, XY_ni * y_ni);
+
+int like_session_init(LikeSession * session, int sig_mode, unsigned char * omega, size_t omega_len, size_t sig_len);
+
+void like_session_reset(LikeSession * session);
+
+void like_session_free(LikeSession * session);
+
+void like_session_get_xy_pairing(LikeSession * session, mclBnGT * xy_pairing);
 
-void verify_mx(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, unsigned char * omega, size_t omega_len, XY_ni * x_ni);
+int verify_mxy_batch(mclBnG2 * Q, size_t n, mclBnG2 ** xyQ, XY_ni ** xy_ni, unsigned char ** omega, size_t * omega_len, int * res);
 
-void ake_b_get_my(mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni);
+int ake_b_get_sigma_Y_1(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1);
 
-void verify_my(mclBnG2 * Q, mclBnG2 * yQ, unsigned char * omega, size_t omega_len, XY_ni * y_ni);
+int verify_sigma_Y_1(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1);
 
-void ake_b_get_sigma_Y_1(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1, size_t sig_len);
+void verify_stats_init(VerifyStats * stats);
 
-void verify_sigma_Y_1(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1, size_t sig_len);
+int ake_O_verify_mxy(VerifyStats * stats, Ed25519Key * pub_key, mclBnG1 * P, mclBnG2 * Q, LikeSession * session, unsigned char * sigma_Y_1, X_eq_ni * x_eq_ni);
 
-void ake_a_get_sigma_X(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, size_t sig_len);
+int ake_a_get_sigma_X(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X);
 
-void verify_sigma_X(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, size_t sig_len);
+int verify_sigma_X(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X);
 
-void ake_b_get_sigma_Y_2(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len);
+int ake_b_get_sigma_Y_2(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2);
 
-void verify_sigma_Y_2(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len);
+int verify_sigma_Y_2(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2);
 
-void ake_a_get_shared_key(mclBnG1 * L_pk, mclBnG2 * yQ, mclBnFr * x, mclBnGT * ka);
+void ake_a_get_shared_key(AggregateKey * L_pk, LikeSession * session, mclBnFr * x, mclBnGT * ka);
 
-void ake_b_get_shared_key(mclBnG1 * L_pk, mclBnG2 * xQ, mclBnFr * y, mclBnGT * kb);
+void ake_b_get_shared_key(AggregateKey * L_pk, LikeSession * session, mclBnFr * y, mclBnGT * kb);
 
-void ake_O_get_sst(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, SST * sst);
+int ake_O_get_sst(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, SST * sst);
 
-void verify_sst(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, SST * sst);
+int verify_sst(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, SST * sst);
 
-void tdgen_get_li_T1(mclBnG1 * xP, mclBnG2 * yQ, int nb_args, ...);
+void tdgen_get_li_T1(LikeSession * session, size_t n, mclBnFr * li_sk, mclBnGT * li_T1);
 
-void tdgen_get_li_T2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, int nb_args, ...);
+int tdgen_get_li_T2(mclBnG1 * P, LikeSession * session, size_t n, mclBnG1 * Li_pk, mclBnFr * li_sk, mclBnGT * li_T1, Lambda_eq_ni * li_T2);
 
-void verify_li_T2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, int nb_args, ...);
+int verify_li_T2(mclBnG1 * P, LikeSession * session, size_t n, mclBnG1 * Li_pk, mclBnGT * li_T1, Lambda_eq_ni * li_T2);
 
-void open_get_shared_key(mclBnGT * k, int nb_args, ...);
+void open_get_shared_key(mclBnGT * k, size_t n, mclBnGT * li_T1);
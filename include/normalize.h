@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "bn512.h"
+
+// Number of points normalized without allocating, larger batches allocate their scratch
+#ifndef LIKE_NORMALIZE_STACK
+#define LIKE_NORMALIZE_STACK 16
+#endif
+
+void normalize_init(mclBnG1 * P, mclBnG2 * Q);
+
+void G1_normalize_batch(mclBnG1 ** P, size_t n);
+
+void G2_normalize_batch(mclBnG2 ** Q, size_t n);
+
+// Normalize copies and leave the points as they are, for points owned by the caller or shared between threads
+// G1_normalize_batch and G2_normalize_batch change the points in place
+void G1_normalize_copy(mclBnG1 * out, mclBnG1 ** P, size_t n);
+
+void G2_normalize_copy(mclBnG2 * out, mclBnG2 ** Q, size_t n);
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bn512.h"
+
+// Miller loop line coefficients of a fixed G2 point
+typedef struct g2_lines
+{
+
+    mclBnG2 base;
+    uint64_t * lines;
+
+} G2_Lines;
+
+int g2_lines_init(G2_Lines * L, mclBnG2 * Q);
+
+void g2_lines_free(G2_Lines * L);
+
+size_t g2_lines_size(void);
+
+void pairing_lines(mclBnGT * res, mclBnG1 * P, G2_Lines * L);
+
+int pairing_init_generator(mclBnG2 * Q);
+
+void pairing_product(mclBnGT * res, mclBnG1 * P, mclBnG2 * Q, size_t n);
+
+int pairing_product_is_one(mclBnG1 * P, mclBnG2 * Q, size_t n);
+
+int pairing_lines_is_one(mclBnG1 * P1, mclBnG2 * Q, mclBnG1 * P2, G2_Lines * L);
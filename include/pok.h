@@ -2,18 +2,47 @@
 
 #include "bn512.h"
 
-void sok_G2(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnG2 * Rho, mclBnFr * d);
+// Encoding of the elements hashed by eq_nipok_G1_GT, part of the proof format
+#define EQ_NIPOK_GT_STR 1 // base 16 strings
+#define EQ_NIPOK_GT_BIN 2 // fixed size serialization
+
+// Proof formats of sok_G2 and nipok_G1
+#define POK_FORMAT_COMMIT 1 // (Rho, d)
+#define POK_FORMAT_COMPACT 2 // (e, d), Rho is recomputed by the verifier
+
+// Length of the challenge of a compact proof (sha256)
+#define CHALLENGE_LENGTH 32
+
+// Provers return LIKE_OK or an error status, verifiers return 1 for a valid proof and 0 otherwise, also when it can not be checked
+
+int sok_G2(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnG2 * Rho, mclBnFr * d);
+
+int sok_G2_precomp(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnFr * r, mclBnG2 * Rho, mclBnFr * d);
 
 int sokver_G2(mclBnG2 * Q, mclBnG2 * xQ, mclBnG2 * Rho, mclBnFr * d, unsigned char * msg, size_t msg_len);
 
-void nipok_G1(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d);
+int sok_G2_compact(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, unsigned char * e, mclBnFr * d);
+
+int sok_G2_compact_precomp(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnFr * r, mclBnG2 * Rho, unsigned char * e, mclBnFr * d);
+
+int sokver_G2_compact(mclBnG2 * Q, mclBnG2 * xQ, unsigned char * e, mclBnFr * d, unsigned char * msg, size_t msg_len);
+
+int sokver_G2_batch(size_t n, mclBnG2 ** Q, mclBnG2 ** xQ, mclBnG2 ** Rho, mclBnFr ** d, unsigned char ** msg, size_t * msg_len, int * res);
+
+int nipok_G1(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d);
 
 int nipokver_G1(mclBnG1 * P, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d);
 
-void eq_nipok_G1_G2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, mclBnFr * x,  mclBnG1 * Rho,  mclBnG2 * Sigma, mclBnFr * d);
+int nipok_G1_compact(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, unsigned char * e, mclBnFr * d);
+
+int nipokver_G1_compact(mclBnG1 * P, mclBnG1 * xP, unsigned char * e, mclBnFr * d);
+
+int nipokver_G1_batch(mclBnG1 * P, size_t n, mclBnG1 ** xP, mclBnG1 ** Rho, mclBnFr ** d, int * res);
+
+int eq_nipok_G1_G2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, mclBnFr * x,  mclBnG1 * Rho,  mclBnG2 * Sigma, mclBnFr * d);
 
 int eq_nipokver_G1_G2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, mclBnG1 * Rho,  mclBnG2 * Sigma, mclBnFr * d);
 
-void eq_nipok_G1_GT(mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1, mclBnFr * li_sk,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d);
+int eq_nipok_G1_GT(int version, mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1, mclBnFr * li_sk,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d);
 
-int eq_nipokver_G1_GT(mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d);
+int eq_nipokver_G1_GT(int version, mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d);
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <pthread.h>
+
+#include "bn512.h"
+#include "utils_like.h"
+
+// Default number of precomputed ephemerals kept by a pool and of threads refilling it
+#ifndef LIKE_POOL_DEPTH
+#define LIKE_POOL_DEPTH 32
+#endif
+
+#ifndef LIKE_POOL_THREADS
+#define LIKE_POOL_THREADS 1
+#endif
+
+// Offline part of ake_a_get_mx / ake_b_get_my : the ephemeral key x and the nonce r of its sok_G2
+typedef struct ephemeral
+{
+
+    mclBnFr x;
+    mclBnG1 xP; // left unset by a pool built without P
+    mclBnG2 xQ;
+    mclBnFr r;
+    mclBnG2 rQ;
+
+} Ephemeral;
+
+typedef struct ephemeral_pool
+{
+
+    mclBnG1 P;
+    mclBnG2 Q;
+    int with_P;
+    Ephemeral * slots;
+    size_t depth;
+    size_t count;
+    pthread_t * threads;
+    size_t nb_threads;
+    pthread_mutex_t lock;
+    pthread_cond_t not_full;
+    pthread_cond_t refilled;
+    int stop;
+
+} EphemeralPool;
+
+int ephemeral_gen(Ephemeral * eph, mclBnG1 * P, mclBnG2 * Q);
+
+void ephemeral_clear(Ephemeral * eph);
+
+int pool_init(EphemeralPool * pool, mclBnG1 * P, mclBnG2 * Q, size_t depth, size_t nb_threads);
+
+int pool_get(EphemeralPool * pool, Ephemeral * eph);
+
+size_t pool_count(EphemeralPool * pool);
+
+void pool_wait_full(EphemeralPool * pool);
+
+void pool_free(EphemeralPool * pool);
@@ -2,10 +2,31 @@
 
 #include <stddef.h>
 
+#include <openssl/evp.h>
+
 #define ED25519_SIG_LENGTH 64
 
-void sgen_ed25519(char * pub_key_path, char * priv_key_path);
+// ed25519 key loaded once from its PEM file, can be shared by threads to sign or verify
+typedef struct ed25519_key
+{
+
+    EVP_PKEY * pkey;
+    int is_private;
+
+} Ed25519Key;
+
+int sgen_ed25519(char * pub_key_path, char * priv_key_path);
+
+int ed25519_key_load_priv(Ed25519Key * key, char * priv_key_path);
+
+int ed25519_key_load_pub(Ed25519Key * key, char * pub_key_path);
+
+void ed25519_key_free(Ed25519Key * key);
+
+int ssig_ed25519_key(Ed25519Key * key, const unsigned char * msg, size_t msg_len, unsigned char ** sig, size_t * sig_len);
+
+int sver_ed25519_key(Ed25519Key * key, const unsigned char * msg, size_t msg_len, unsigned char * sig, size_t sig_len);
 
-void ssig_ed25519(char * priv_key_path, const unsigned char * msg, size_t msg_len, unsigned char ** sig, size_t * sig_len);
+int ssig_ed25519(char * priv_key_path, const unsigned char * msg, size_t msg_len, unsigned char ** sig, size_t * sig_len);
 
-void sver_ed25519(char * pub_key_path, const unsigned char * msg, size_t msg_len, unsigned char * sig, size_t sig_len);
+int sver_ed25519(char * pub_key_path, const unsigned char * msg, size_t msg_len, unsigned char * sig, size_t sig_len);
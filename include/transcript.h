@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+
+#include <openssl/evp.h>
+
+#include "bn512.h"
+
+// Buffer size for the base 16 string representation of a G1 or GT element
+#define STR_MAX_LENGTH 4096
+
+// A failure is kept in status, the later absorbs are skipped and it is returned by transcript_get_hash
+typedef struct transcript
+{
+
+    EVP_MD_CTX * md_ctx;
+    int status;
+
+} Transcript;
+
+void transcript_init(Transcript * t);
+
+void transcript_absorb_bytes(Transcript * t, const unsigned char * data, size_t data_len);
+
+void transcript_absorb_Fr(Transcript * t, mclBnFr * x);
+
+void transcript_absorb_G1(Transcript * t, mclBnG1 * x);
+
+void transcript_absorb_G2(Transcript * t, mclBnG2 * x);
+
+void transcript_absorb_G1_vec(Transcript * t, mclBnG1 ** x, size_t n);
+
+void transcript_absorb_G2_vec(Transcript * t, mclBnG2 ** x, size_t n);
+
+void transcript_absorb_GT(Transcript * t, mclBnGT * x);
+
+void transcript_absorb_G1_str(Transcript * t, mclBnG1 * x);
+
+void transcript_absorb_GT_str(Transcript * t, mclBnGT * x);
+
+int transcript_get_hash(Transcript * t, unsigned char * hash);
+
+int transcript_get_challenge(Transcript * t, mclBnFr * e);
@@ -2,10 +2,27 @@
 
 #include <stddef.h>
 
-void handle_mcl_error(int rc, char * msg);
+#include "bn512.h"
+
+// Status codes returned by the library, nothing in the library exits the process
+#define LIKE_OK 0
+#define LIKE_ERR_VERIFY 1 // a proof or a signature does not verify, only this session is rejected
+#define LIKE_ERR_MCL 2 // an mcl call failed
+#define LIKE_ERR_CRYPTO 3 // an openssl call failed
+#define LIKE_ERR_MALLOC 4 // an allocation failed
+#define LIKE_ERR_IO 5 // a key file can not be opened
+#define LIKE_ERR_THREAD 6 // a thread can not be started
+
+int handle_mcl_error(int rc, char * msg);
 
 char *  bytes_to_hexstring(unsigned char * data_bytes, size_t data_bytes_len);
 
+int hash_to_Fr_hexstring(mclBnFr * e, unsigned char * hash);
+
+int hash_to_Fr(mclBnFr * e, unsigned char * hash);
+
+int rand_Fr_128(mclBnFr * w);
+
 unsigned char * sha256(unsigned char * data, size_t data_len);
 
 void concat_arrays(unsigned char * buffer, int nb_args, ...);
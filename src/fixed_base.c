@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bn512.h"
+#include "fixed_base.h"
+#include "utils_like.h"
+
+// Tables of the generators P and Q, built by setup()
+static FB_G1 fb_P;
+static FB_G2 fb_Q;
+
+/*
+ * Get the number of windows needed to cover the bits of an Fr element
+ */
+static size_t fb_get_nb_windows(int window)
+{
+
+    size_t nb_bits = mclBn_getFrByteSize() * 8;
+
+    return (nb_bits + window - 1) / window;
+
+}
+
+/*
+ * Get the little-endian bytes of a scalar
+ * k_bytes : buffer of FR_MAX_LENGTH bytes
+ * return : 1 if success
+ */
+static int fb_get_scalar_bytes(unsigned char * k_bytes, mclBnFr * k)
+{
+
+    memset(k_bytes, 0, FR_MAX_LENGTH);
+
+    return mclBnFr_getLittleEndian(k_bytes, FR_MAX_LENGTH, k) != 0;
+
+}
+
+/*
+ * Get the window-th group of window bits of a little-endian integer
+ */
+static size_t fb_get_digit(unsigned char * k_bytes, size_t i, int window)
+{
+
+    size_t digit = 0;
+    size_t bit = i * window;
+
+    for(int j = 0; j < window && (bit + j) < (FR_MAX_LENGTH * 8); j++)
+    {
+        digit |= (size_t)((k_bytes[(bit + j) / 8] >> ((bit + j) % 8)) & 1) << j;
+    }
+
+    return digit;
+
+}
+
+/*
+ * Build a fixed-base table for a G1 point
+ * For each window i, the table holds j * 2^(i * window) * base for j in [1, 2^window - 1], in affine coordinates
+ * A multiplication then costs one addition per window and no doubling
+ * fb : table to build, must be released with fb_G1_free
+ * base : point to precompute
+ * window : window size in bits, from 1 to 16
+ * return : LIKE_OK or LIKE_ERR_MALLOC
+ */
+int fb_G1_init(FB_G1 * fb, mclBnG1 * base, int window)
+{
+
+    size_t row_len = ((size_t)1 << window) - 1;
+    mclBnG1 row_base;
+
+    fb->base = *base;
+    fb->window = window;
+    fb->nb_windows = fb_get_nb_windows(window);
+    fb->table = (mclBnG1 *) malloc(fb->nb_windows * row_len * sizeof(mclBnG1));
+    if(fb->table == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return LIKE_ERR_MALLOC;
+    }
+
+    row_base = *base;
+    for(size_t i = 0; i < fb->nb_windows; i++)
+    {
+        mclBnG1 * row = fb->table + (i * row_len);
+
+        // row[j - 1] <-- j * 2^(i * window) * base
+        row[0] = row_base;
+        for(size_t j = 1; j < row_len; j++)
+        {
+            mclBnG1_add(&row[j], &row[j - 1], &row_base);
+        }
+
+        // row_base <-- 2^window * row_base
+        mclBnG1_add(&row_base, &row[row_len - 1], &row_base);
+
+        for(size_t j = 0; j < row_len; j++)
+        {
+            mclBnG1_normalize(&row[j], &row[j]);
+        }
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Multiply the base of a fixed-base table by a scalar
+ * z : buffer of G1 object to receive z <-- k * base
+ * fb : table of base
+ * k : scalar
+ */
+void fb_G1_mul(mclBnG1 * z, FB_G1 * fb, mclBnFr * k)
+{
+
+    size_t digit;
+    size_t row_len = ((size_t)1 << fb->window) - 1;
+    unsigned char k_bytes[FR_MAX_LENGTH];
+
+    // Without the bytes of k, fall back on the generic multiplication
+    if(fb_get_scalar_bytes(k_bytes, k) == 0)
+    {
+        mclBnG1_mul(z, &fb->base, k);
+        return;
+    }
+
+    mclBnG1_clear(z);
+    for(size_t i = 0; i < fb->nb_windows; i++)
+    {
+        digit = fb_get_digit(k_bytes, i, fb->window);
+        if(digit != 0)
+        {
+            mclBnG1_add(z, z, &fb->table[(i * row_len) + digit - 1]);
+        }
+    }
+
+}
+
+/*
+ * Release a fixed-base table
+ */
+void fb_G1_free(FB_G1 * fb)
+{
+
+    free(fb->table);
+    fb->table = NULL;
+
+}
+
+/*
+ * Get the memory used by a fixed-base table in bytes
+ */
+size_t fb_G1_size(FB_G1 * fb)
+{
+
+    return fb->nb_windows * (((size_t)1 << fb->window) - 1) * sizeof(mclBnG1);
+
+}
+
+/*
+ * Build a fixed-base table for a G2 point, see fb_G1_init
+ */
+int fb_G2_init(FB_G2 * fb, mclBnG2 * base, int window)
+{
+
+    size_t row_len = ((size_t)1 << window) - 1;
+    mclBnG2 row_base;
+
+    fb->base = *base;
+    fb->window = window;
+    fb->nb_windows = fb_get_nb_windows(window);
+    fb->table = (mclBnG2 *) malloc(fb->nb_windows * row_len * sizeof(mclBnG2));
+    if(fb->table == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return LIKE_ERR_MALLOC;
+    }
+
+    row_base = *base;
+    for(size_t i = 0; i < fb->nb_windows; i++)
+    {
+        mclBnG2 * row = fb->table + (i * row_len);
+
+        // row[j - 1] <-- j * 2^(i * window) * base
+        row[0] = row_base;
+        for(size_t j = 1; j < row_len; j++)
+        {
+            mclBnG2_add(&row[j], &row[j - 1], &row_base);
+        }
+
+        // row_base <-- 2^window * row_base
+        mclBnG2_add(&row_base, &row[row_len - 1], &row_base);
+
+        for(size_t j = 0; j < row_len; j++)
+        {
+            mclBnG2_normalize(&row[j], &row[j]);
+        }
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Multiply the base of a fixed-base table by a scalar, see fb_G1_mul
+ */
+void fb_G2_mul(mclBnG2 * z, FB_G2 * fb, mclBnFr * k)
+{
+
+    size_t digit;
+    size_t row_len = ((size_t)1 << fb->window) - 1;
+    unsigned char k_bytes[FR_MAX_LENGTH];
+
+    // Without the bytes of k, fall back on the generic multiplication
+    if(fb_get_scalar_bytes(k_bytes, k) == 0)
+    {
+        mclBnG2_mul(z, &fb->base, k);
+        return;
+    }
+
+    mclBnG2_clear(z);
+    for(size_t i = 0; i < fb->nb_windows; i++)
+    {
+        digit = fb_get_digit(k_bytes, i, fb->window);
+        if(digit != 0)
+        {
+            mclBnG2_add(z, z, &fb->table[(i * row_len) + digit - 1]);
+        }
+    }
+
+}
+
+/*
+ * Release a fixed-base table
+ */
+void fb_G2_free(FB_G2 * fb)
+{
+
+    free(fb->table);
+    fb->table = NULL;
+
+}
+
+/*
+ * Get the memory used by a fixed-base table in bytes
+ */
+size_t fb_G2_size(FB_G2 * fb)
+{
+
+    return fb->nb_windows * (((size_t)1 << fb->window) - 1) * sizeof(mclBnG2);
+
+}
+
+/*
+ * Build the tables of the generators, used by G1_mul_gen and G2_mul_gen
+ * P : G1 generator
+ * Q : G2 generator
+ * window : window size in bits
+ * return : LIKE_OK or LIKE_ERR_MALLOC, the multiplications by the generators then stay generic
+ */
+int fb_init_generators(mclBnG1 * P, mclBnG2 * Q, int window)
+{
+
+    int status;
+
+    fb_G1_free(&fb_P);
+    fb_G2_free(&fb_Q);
+
+    status = fb_G1_init(&fb_P, P, window);
+    if(status != LIKE_OK)
+    {
+        return status;
+    }
+
+    return fb_G2_init(&fb_Q, Q, window);
+
+}
+
+/*
+ * Multiply a G1 point by a scalar, with the fixed-base table when the point is the generator given to setup()
+ * z : buffer of G1 object to receive z <-- k * P
+ */
+void G1_mul_gen(mclBnG1 * z, mclBnG1 * P, mclBnFr * k)
+{
+
+    if(fb_P.table != NULL && mclBnG1_isEqual(P, &fb_P.base))
+    {
+        fb_G1_mul(z, &fb_P, k);
+    }
+    else
+    {
+        mclBnG1_mul(z, P, k);
+    }
+
+}
+
+/*
+ * Multiply a G2 point by a scalar, with the fixed-base table when the point is the generator given to setup()
+ * z : buffer of G2 object to receive z <-- k * Q
+ */
+void G2_mul_gen(mclBnG2 * z, mclBnG2 * Q, mclBnFr * k)
+{
+
+    if(fb_Q.table != NULL && mclBnG2_isEqual(Q, &fb_Q.base))
+    {
+        fb_G2_mul(z, &fb_Q, k);
+    }
+    else
+    {
+        mclBnG2_mul(z, Q, k);
+    }
+
+}
@@ -0,0 +1,434 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "key_cache.h"
+#include "utils_like.h"
+
+static const unsigned char key_cache_magic[8] = "LIKEKC1";
+
+/*
+ * Take the lock of the cache file, held by one process at a time while it reads or writes the table
+ * return : LIKE_OK or LIKE_ERR_IO
+ */
+static int key_cache_lock(KeyCache * cache)
+{
+
+    if(flock(cache->fd, LOCK_EX) != 0)
+    {
+        fprintf(stderr, "Error with flock\n");
+        return LIKE_ERR_IO;
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Release the lock of the cache file
+ */
+static void key_cache_unlock(KeyCache * cache)
+{
+
+    flock(cache->fd, LOCK_UN);
+
+}
+
+/*
+ * Check that the file holds a cache whose header matches its size and is at most half full
+ * nb_slots : buffer to receive the number of slots of the file
+ * return : 1 if the file can be mapped as it is
+ */
+static int key_cache_check_file(int fd, size_t * nb_slots)
+{
+
+    struct stat st;
+    KeyCacheHeader header;
+
+    if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(header)
+        || pread(fd, &header, sizeof(header), 0) != (ssize_t) sizeof(header))
+    {
+        return 0;
+    }
+
+    if(memcmp(header.magic, key_cache_magic, sizeof(key_cache_magic)) != 0
+        || header.nb_slots == 0 || (header.nb_slots & (header.nb_slots - 1)) != 0
+        || header.nb_slots > (SIZE_MAX - sizeof(header)) / KEY_CACHE_DIGEST_LENGTH
+        || (size_t) st.st_size != sizeof(header) + (header.nb_slots * KEY_CACHE_DIGEST_LENGTH)
+        || header.count > header.nb_slots / 2)
+    {
+        return 0;
+    }
+
+    *nb_slots = header.nb_slots;
+
+    return 1;
+
+}
+
+/*
+ * Map the cache file with room for nb_slots digests
+ * resize : 1 to set the file size and the header to nb_slots, 0 if the file already has this size
+ * return : LIKE_OK or LIKE_ERR_IO
+ */
+static int key_cache_map(KeyCache * cache, size_t nb_slots, int resize)
+{
+
+    size_t map_len = sizeof(KeyCacheHeader) + (nb_slots * KEY_CACHE_DIGEST_LENGTH);
+    void * map;
+
+    if(resize && ftruncate(cache->fd, map_len) != 0)
+    {
+        fprintf(stderr, "Error with ftruncate\n");
+        return LIKE_ERR_IO;
+    }
+
+    map = mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_SHARED, cache->fd, 0);
+    if(map == MAP_FAILED)
+    {
+        fprintf(stderr, "Error with mmap\n");
+        return LIKE_ERR_IO;
+    }
+
+    cache->header = (KeyCacheHeader *) map;
+    cache->slots = (unsigned char *) map + sizeof(KeyCacheHeader);
+    cache->map_len = map_len;
+    cache->nb_slots = nb_slots;
+    if(resize)
+    {
+        cache->header->nb_slots = nb_slots;
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Unmap the cache file, the digests written in the mapping are kept by the file
+ */
+static void key_cache_unmap(KeyCache * cache)
+{
+
+    if(cache->header != NULL)
+    {
+        munmap(cache->header, cache->map_len);
+    }
+    cache->header = NULL;
+    cache->slots = NULL;
+    cache->map_len = 0;
+    cache->nb_slots = 0;
+
+}
+
+/*
+ * Empty the cache and set it to the epoch of the handle
+ */
+static void key_cache_reset(KeyCache * cache)
+{
+
+    memset(cache->slots, 0, cache->nb_slots * KEY_CACHE_DIGEST_LENGTH);
+    memcpy(cache->header->magic, key_cache_magic, sizeof(key_cache_magic));
+    cache->header->epoch = cache->epoch;
+    cache->header->count = 0;
+
+}
+
+/*
+ * Map the cache file again with its current size, the lock must be held
+ * The digests are dropped if the file is not a valid cache or was written for an other epoch
+ * return : LIKE_OK or LIKE_ERR_IO, the cache is then left unmapped
+ */
+static int key_cache_load(KeyCache * cache)
+{
+
+    int rc;
+    size_t nb_slots = LIKE_KEY_CACHE_SLOTS;
+    int valid = key_cache_check_file(cache->fd, &nb_slots);
+
+    key_cache_unmap(cache);
+    rc = key_cache_map(cache, nb_slots, valid == 0);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+
+    if(valid == 0 || cache->header->epoch != cache->epoch)
+    {
+        key_cache_reset(cache);
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Follow the changes made to the file by the other processes since the last access, the lock must be held
+ * The mapping of the handle is only valid for its own nb_slots, the file is mapped again once an other process grew it
+ * return : LIKE_OK or LIKE_ERR_IO
+ */
+static int key_cache_sync(KeyCache * cache)
+{
+
+    if(cache->header == NULL || cache->header->nb_slots != cache->nb_slots)
+    {
+        return key_cache_load(cache);
+    }
+
+    if(cache->header->epoch != cache->epoch || cache->header->count > cache->nb_slots / 2)
+    {
+        key_cache_reset(cache);
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * return : 1 if the digest is all zero, the marker of an empty slot
+ */
+static int key_cache_is_empty(unsigned char * digest)
+{
+
+    unsigned char acc = 0;
+
+    for(size_t i = 0; i < KEY_CACHE_DIGEST_LENGTH; i++)
+    {
+        acc |= digest[i];
+    }
+
+    return acc == 0;
+
+}
+
+/*
+ * Find the slot of a digest by linear probing from its first 8 bytes
+ * The table is kept at most half full, the probing still stops after nb_slots slots if the file was filled by hand
+ * return : pointer to the slot holding the digest, to the empty slot where it goes or NULL if the table is full
+ */
+static unsigned char * key_cache_find(KeyCache * cache, unsigned char * digest)
+{
+
+    uint64_t i;
+    uint64_t mask = cache->nb_slots - 1;
+    unsigned char * slot;
+
+    memcpy(&i, digest, sizeof(i));
+    i &= mask;
+
+    for(size_t j = 0; j < cache->nb_slots; j++)
+    {
+        slot = cache->slots + (i * KEY_CACHE_DIGEST_LENGTH);
+        if(memcmp(slot, digest, KEY_CACHE_DIGEST_LENGTH) == 0 || key_cache_is_empty(slot))
+        {
+            return slot;
+        }
+        i = (i + 1) & mask;
+    }
+
+    return NULL;
+
+}
+
+/*
+ * Double the number of slots of the cache and insert its digests again, the lock must be held
+ * return : LIKE_OK, LIKE_ERR_MALLOC or LIKE_ERR_IO, the cache is then left unmapped
+ */
+static int key_cache_grow(KeyCache * cache)
+{
+
+    int rc;
+    size_t nb_slots = cache->nb_slots;
+    unsigned char * old_slots = (unsigned char *) malloc(nb_slots * KEY_CACHE_DIGEST_LENGTH);
+    if(old_slots == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return LIKE_ERR_MALLOC;
+    }
+    memcpy(old_slots, cache->slots, nb_slots * KEY_CACHE_DIGEST_LENGTH);
+
+    key_cache_unmap(cache);
+    rc = key_cache_map(cache, nb_slots * 2, 1);
+    if(rc != LIKE_OK)
+    {
+        free(old_slots);
+        return rc;
+    }
+    key_cache_reset(cache);
+
+    // At most half of the new slots are used so a slot is always found
+    for(size_t i = 0; i < nb_slots; i++)
+    {
+        unsigned char * digest = old_slots + (i * KEY_CACHE_DIGEST_LENGTH);
+        unsigned char * slot;
+        if(key_cache_is_empty(digest) == 0 && (slot = key_cache_find(cache, digest)) != NULL)
+        {
+            memcpy(slot, digest, KEY_CACHE_DIGEST_LENGTH);
+            cache->header->count++;
+        }
+    }
+
+    free(old_slots);
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Open the verified keys cache of a file, created if it does not exist
+ * The digests of the file are dropped if it was written for an other epoch, is not a cache file or is over half full
+ * Whoever can write the file can make a key skip its verification, it is created readable by its owner only
+ * Several processes can share the file, each access takes its lock
+ * cache : cache to open, must be closed with key_cache_close
+ * path : path and name of the cache file
+ * epoch : epoch of the authority set, to change when the set of authorities changes
+ * return : LIKE_OK or LIKE_ERR_IO
+ */
+int key_cache_open(KeyCache * cache, char * path, uint64_t epoch)
+{
+
+    int rc;
+
+    cache->header = NULL;
+    cache->slots = NULL;
+    cache->map_len = 0;
+    cache->nb_slots = 0;
+    cache->epoch = epoch;
+    cache->fd = open(path, O_RDWR | O_CREAT, 0600);
+    if(cache->fd < 0)
+    {
+        fprintf(stderr, "Open %s failed\n", path);
+        return LIKE_ERR_IO;
+    }
+
+    rc = key_cache_lock(cache);
+    if(rc == LIKE_OK)
+    {
+        rc = key_cache_load(cache);
+        key_cache_unlock(cache);
+    }
+    if(rc != LIKE_OK)
+    {
+        key_cache_unmap(cache);
+        close(cache->fd);
+        cache->fd = -1;
+        return rc;
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * digest : digest of KEY_CACHE_DIGEST_LENGTH bytes
+ * return : 1 if the digest is in the cache
+ */
+int key_cache_contains(KeyCache * cache, unsigned char * digest)
+{
+
+    int found = 0;
+    unsigned char * slot;
+
+    if(cache->fd < 0 || key_cache_is_empty(digest) || key_cache_lock(cache) != LIKE_OK)
+    {
+        return 0;
+    }
+
+    if(key_cache_sync(cache) == LIKE_OK)
+    {
+        slot = key_cache_find(cache, digest);
+        found = (slot != NULL && key_cache_is_empty(slot) == 0);
+    }
+
+    key_cache_unlock(cache);
+
+    return found;
+
+}
+
+/*
+ * Add a digest to the cache, the file is grown when it gets half full
+ * return : LIKE_OK or an error status, the digest is then not cached
+ */
+int key_cache_insert(KeyCache * cache, unsigned char * digest)
+{
+
+    int rc;
+    unsigned char * slot;
+
+    if(cache->fd < 0)
+    {
+        return LIKE_ERR_IO;
+    }
+
+    if(key_cache_is_empty(digest))
+    {
+        return LIKE_OK;
+    }
+
+    rc = key_cache_lock(cache);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+
+    rc = key_cache_sync(cache);
+    if(rc != LIKE_OK)
+    {
+        goto err;
+    }
+
+    slot = key_cache_find(cache, digest);
+    if(slot != NULL && key_cache_is_empty(slot) == 0)
+    {
+        goto err;
+    }
+
+    if(slot == NULL || (cache->header->count + 1) * 2 > cache->nb_slots)
+    {
+        rc = key_cache_grow(cache);
+        if(rc != LIKE_OK)
+        {
+            goto err;
+        }
+        slot = key_cache_find(cache, digest);
+        if(slot == NULL)
+        {
+            rc = LIKE_ERR_IO;
+            goto err;
+        }
+    }
+
+    memcpy(slot, digest, KEY_CACHE_DIGEST_LENGTH);
+    cache->header->count++;
+
+    err:
+        key_cache_unlock(cache);
+
+    return rc;
+
+}
+
+/*
+ * Write the cache back to its file and close it
+ */
+void key_cache_close(KeyCache * cache)
+{
+
+    if(cache->header != NULL)
+    {
+        msync(cache->header, cache->map_len, MS_SYNC);
+    }
+    key_cache_unmap(cache);
+
+    if(cache->fd >= 0)
+    {
+        close(cache->fd);
+    }
+    cache->fd = -1;
+
+}
@@ -1,21 +1,30 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
 
 #include "pok.h"
 #include "like.h"
 #include "bn512.h"
+#include "pairing.h"
+#include "pool.h"
+#include "transcript.h"
+#include "normalize.h"
+#include "fixed_base.h"
+#include "key_cache.h"
 #include "utils_like.h"
 
 const char * G1_basePoint_hexstr = "1 21a6d67ef250191fadba34a0a30160b9ac9264b6f95f63b3edbec3cf4b2e689db1bbb4e69a416a0b1e79239c0372e5cd70113c98d91f36b6980d 0118ea0460f7f7abb82b33676a7432a490eeda842cccfa7d788c659650426e6af77df11b8ae40eb80f475432c66600622ecaa8a5734d36fb03de";
 const char * G2_basePoint_hexstr = "1 0257ccc85b58dda0dfb38e3a8cbdc5482e0337e7c1cd96ed61c913820408208f9ad2699bad92e0032ae1f0aa6a8b48807695468e3d934ae1e4df 1d2e4343e8599102af8edca849566ba3c98e2a354730cbed9176884058b18134dd86bae555b783718f50af8b59bf7e850e9b73108ba6aa8cd283 0a0650439da22c1979517427a20809eca035634706e23c3fa7a6bb42fe810f1399a1f41c9ddae32e03695a140e7b11d7c3376e5b68df0db7154e 073ef0cbd438cbe0172c8ae37306324d44d5e6b0c69ac57b393f1ab370fd725cc647692444a04ef87387aa68d53743493b9eba14cc552ca2a93a";
 
 /*
- * Init pairing over a bn462 curve and set generator of G1 and G2
+ * Init pairing over a bn462 curve, set generator of G1 and G2, find the coordinates used by mcl for the batch normalizations,
+ * build the fixed-base tables and precompute the Miller loop lines of the G2 generator
+ * The window of the tables is set at compile time with LIKE_FB_WINDOW
  * P : pointer to store the G1 generator
  * G : pointer to store the G2 generator
+ * return : LIKE_OK, LIKE_ERR_MCL or LIKE_ERR_MALLOC if a table can not be built, the generic multiplications are then used
  */
-void setup(mclBnG1 * P, mclBnG2 * Q)
+int setup(mclBnG1 * P, mclBnG2 * Q)
 {
 
     int rc;
@@ -23,21 +32,31 @@ void setup(mclBnG1 * P, mclBnG2 * Q)
     rc = mclBn_init(MCL_BN462, MCLBN_COMPILED_TIME_VAR);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBn_init");
+        return handle_mcl_error(rc, "Error with mclBn_init");
     }
 
     rc = mclBnG1_setStr(P, G1_basePoint_hexstr, strlen(G1_basePoint_hexstr), 16);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_setStr");
+        return handle_mcl_error(rc, "Error with mclBnG1_setStr");
     }
 
     rc = mclBnG2_setStr(Q, G2_basePoint_hexstr, strlen(G2_basePoint_hexstr), 16);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnG2_setStr");
+        return handle_mcl_error(rc, "Error with mclBnG2_setStr");
     }
 
+    normalize_init(P, Q);
+
+    rc = fb_init_generators(P, Q, LIKE_FB_WINDOW);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+
+    return pairing_init_generator(Q);
+
 }
 
 /*
@@ -53,9 +72,11 @@ void setup(mclBnG1 * P, mclBnG2 * Q)
 }*/
 
 /*
- *
+ * Generate the key pair of an authority and the proof of knowledge of its secret key
+ * format : POK_FORMAT_COMMIT for a (Rho, d) proof or POK_FORMAT_COMPACT for a (e, d) proof
+ * return : LIKE_OK or an error status
  */
-void a_key_gen(mclBnG1 * P, mclBnFr * lambda_sk, mclBnG1 * lambda_pk, Lambda_ni * lambda_ni)
+int a_key_gen(int format, mclBnG1 * P, mclBnFr * lambda_sk, mclBnG1 * lambda_pk, Lambda_ni * lambda_ni)
 {
 
     int rc;
@@ -63,880 +84,1520 @@ void a_key_gen(mclBnG1 * P, mclBnFr * lambda_sk, mclBnG1 * lambda_pk, Lambda_ni
     rc = mclBnFr_setByCSPRNG(lambda_sk);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+    }
+
+    G1_mul_gen(lambda_pk, P, lambda_sk);
+
+    lambda_ni->format = format;
+    if(format == POK_FORMAT_COMPACT)
+    {
+        return nipok_G1_compact(P, lambda_sk, lambda_pk, lambda_ni->e, &lambda_ni->d);
+    }
+
+    return nipok_G1(P, lambda_sk, lambda_pk, &lambda_ni->Rho, &lambda_ni->d);
+
+}
+
+/*
+ * Check each Lambda_ni proof, the commit ones in one batch whose bisection finds the invalid ones
+ * Compact proofs cannot be batched and are verified one by one
+ * res : array of n int to receive 1 for each valid proof and 0 for each invalid one
+ * return : LIKE_OK, LIKE_ERR_VERIFY if one of them is invalid or LIKE_ERR_MALLOC, all rejected in res
+ */
+static int lambda_ni_check(mclBnG1 * P, size_t n, mclBnG1 * Li_pk, Lambda_ni * li_ni, int * res)
+{
+
+    size_t nb_batch = 0;
+    int result = LIKE_OK;
+    mclBnG1 ** Li_pk_batch = (mclBnG1 **) malloc(n * sizeof(mclBnG1 *));
+    mclBnG1 ** Rho = (mclBnG1 **) malloc(n * sizeof(mclBnG1 *));
+    mclBnFr ** d = (mclBnFr **) malloc(n * sizeof(mclBnFr *));
+    size_t * index = (size_t *) malloc(n * sizeof(size_t));
+    int * res_batch = (int *) malloc(n * sizeof(int));
+    if(Li_pk_batch == NULL || Rho == NULL || d == NULL || index == NULL || res_batch == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        for(size_t i = 0; i < n; i++)
+        {
+            res[i] = 0;
+        }
+        result = LIKE_ERR_MALLOC;
+        goto err;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if(li_ni[i].format == POK_FORMAT_COMPACT)
+        {
+            res[i] = nipokver_G1_compact(P, &Li_pk[i], li_ni[i].e, &li_ni[i].d);
+            if(res[i] != 1)
+            {
+                result = LIKE_ERR_VERIFY;
+            }
+            continue;
+        }
+        Li_pk_batch[nb_batch] = &Li_pk[i];
+        Rho[nb_batch] = &li_ni[i].Rho;
+        d[nb_batch] = &li_ni[i].d;
+        index[nb_batch] = i;
+        nb_batch++;
+    }
+
+    if(nb_batch > 0 && nipokver_G1_batch(P, nb_batch, Li_pk_batch, Rho, d, res_batch) != 1)
+    {
+        result = LIKE_ERR_VERIFY;
+    }
+    for(size_t i = 0; i < nb_batch; i++)
+    {
+        res[index[i]] = (result == LIKE_OK) ? 1 : res_batch[i];
+    }
+
+    err:
+        free(Li_pk_batch);
+        free(Rho);
+        free(d);
+        free(index);
+        free(res_batch);
+
+    return result;
+
+}
+
+/*
+ * Verify the Lambda_ni proofs of the authorities keys in one batch
+ * Compact proofs cannot be batched and are verified one by one
+ * P : Base point of the G1 elliptic curve group
+ * n : number of authorities
+ * Li_pk : array of the n authorities public keys
+ * li_ni : array of the n authorities proofs
+ * return : LIKE_OK, LIKE_ERR_VERIFY if one of them is invalid or LIKE_ERR_MALLOC
+ */
+int verify_L_ni(mclBnG1 * P, size_t n, mclBnG1 * Li_pk, Lambda_ni * li_ni)
+{
+
+    int result;
+    int * res = (int *) malloc(n * sizeof(int));
+    if(res == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return LIKE_ERR_MALLOC;
+    }
+
+    result = lambda_ni_check(P, n, Li_pk, li_ni, res);
+    for(size_t i = 0; result == LIKE_ERR_VERIFY && i < n; i++)
+    {
+        if(res[i] != 1)
+        {
+            fprintf(stderr, "NIZKP verification failed for authority %zu\n", i);
+        }
+    }
+
+    free(res);
+
+    return result;
+
+}
+
+/*
+ * Digest of an authority key and of its proof, the entry of the key in the verified keys cache
+ * digest : buffer of KEY_CACHE_DIGEST_LENGTH bytes to receive H(format||Li_pk||Rho or e||d)
+ * return : LIKE_OK or an error status
+ */
+static int lambda_ni_digest(mclBnG1 * Li_pk, Lambda_ni * li_ni, unsigned char * digest)
+{
+
+    Transcript t;
+    unsigned char format = (unsigned char) li_ni->format;
+
+    transcript_init(&t);
+    transcript_absorb_bytes(&t, &format, 1);
+    transcript_absorb_G1(&t, Li_pk);
+    if(li_ni->format == POK_FORMAT_COMPACT)
+    {
+        transcript_absorb_bytes(&t, li_ni->e, CHALLENGE_LENGTH);
+    }
+    else
+    {
+        transcript_absorb_G1(&t, &li_ni->Rho);
+    }
+    transcript_absorb_Fr(&t, &li_ni->d);
+
+    return transcript_get_hash(&t, digest);
+
+}
+
+/*
+ * Same as verify_L_ni, the proofs already in the cache are not checked again and the new valid ones are added to it
+ * The new proofs are verified in one batch, whose bisection finds the invalid ones : the valid ones are cached even if one is invalid
+ * cache : verified keys cache opened with key_cache_open for the epoch of the authority set
+ * return : LIKE_OK, LIKE_ERR_VERIFY if one of the proofs out of the cache is invalid or an error status
+ */
+int verify_L_ni_cached(KeyCache * cache, mclBnG1 * P, size_t n, mclBnG1 * Li_pk, Lambda_ni * li_ni)
+{
+
+    int rc = LIKE_OK;
+    size_t nb_miss = 0;
+    unsigned char * digests = (unsigned char *) malloc(n * KEY_CACHE_DIGEST_LENGTH);
+    mclBnG1 * Li_pk_miss = (mclBnG1 *) malloc(n * sizeof(mclBnG1));
+    Lambda_ni * li_ni_miss = (Lambda_ni *) malloc(n * sizeof(Lambda_ni));
+    int * res = (int *) malloc(n * sizeof(int));
+    size_t * index = (size_t *) malloc(n * sizeof(size_t));
+    mclBnG1 ** points = (mclBnG1 **) malloc((2 * n) * sizeof(mclBnG1 *));
+    size_t nb_points = 0;
+    if(digests == NULL || Li_pk_miss == NULL || li_ni_miss == NULL || res == NULL || index == NULL || points == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        rc = LIKE_ERR_MALLOC;
+        goto err;
+    }
+
+    // One inversion for all the G1 points of the digests, on the copies packed down to the misses below
+    for(size_t i = 0; i < n; i++)
+    {
+        Li_pk_miss[i] = Li_pk[i];
+        li_ni_miss[i] = li_ni[i];
+        points[nb_points++] = &Li_pk_miss[i];
+        if(li_ni[i].format == POK_FORMAT_COMMIT)
+        {
+            points[nb_points++] = &li_ni_miss[i].Rho;
+        }
+    }
+    G1_normalize_batch(points, nb_points);
+
+    // The copies are then packed down to the keys missing from the cache
+    for(size_t i = 0; i < n; i++)
+    {
+        unsigned char * digest = digests + (nb_miss * KEY_CACHE_DIGEST_LENGTH);
+
+        rc = lambda_ni_digest(&Li_pk_miss[i], &li_ni_miss[i], digest);
+        if(rc != LIKE_OK)
+        {
+            goto err;
+        }
+        if(key_cache_contains(cache, digest))
+        {
+            continue;
+        }
+        Li_pk_miss[nb_miss] = Li_pk_miss[i];
+        li_ni_miss[nb_miss] = li_ni_miss[i];
+        index[nb_miss] = i;
+        nb_miss++;
+    }
+
+    if(nb_miss == 0)
+    {
+        goto err;
+    }
+
+    rc = lambda_ni_check(P, nb_miss, Li_pk_miss, li_ni_miss, res);
+
+    // A failed insert only means the proof is checked again next time
+    for(size_t i = 0; i < nb_miss; i++)
+    {
+        if(res[i] == 1)
+        {
+            key_cache_insert(cache, digests + (i * KEY_CACHE_DIGEST_LENGTH));
+        }
+        else
+        {
+            fprintf(stderr, "NIZKP verification failed for authority %zu\n", index[i]);
+        }
+    }
+
+    err:
+        free(digests);
+        free(Li_pk_miss);
+        free(li_ni_miss);
+        free(res);
+        free(index);
+        free(points);
+
+    return rc;
+
+}
+
+/*
+ * Aggregate the authorities public keys
+ * L_pk : buffer of G1 object to receive L_pk <-- Li_pk[0] + ... + Li_pk[n-1]
+ * n : number of authorities
+ * Li_pk : array of the n authorities public keys
+ */
+void ake_precalc_add_lipk(mclBnG1 * L_pk, size_t n, mclBnG1 * Li_pk)
+{
+
+    mclBnG1_clear(L_pk);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        mclBnG1_add(L_pk, L_pk, &Li_pk[i]);
+    }
+
+}
+
+/*
+ * format : POK_FORMAT_COMMIT for a (Rho, d) x_ni or POK_FORMAT_COMPACT for a (e, d) x_ni
+ * x_eq_ni : buffer to receive the proof that log_P(xP) == log_Q(xQ), NULL to let the verifiers use pairings
+ * return : LIKE_OK or an error status
+ */
+int ake_a_get_mx(int format, mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, X_eq_ni * x_eq_ni)
+{
+
+    int rc;
+
+    // r <-$- Fr
+    rc = mclBnFr_setByCSPRNG(x);
+    if(rc != 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+    }
+
+    // xP <-- x * P
+    G1_mul_gen(xP, P, x);
+
+    // xQ <-- x * Q
+    G2_mul_gen(xQ, Q, x);
+
+    // ni_X <-- SoK_omega(x : xQ <-- x * Q)
+    x_ni->format = format;
+    if(format == POK_FORMAT_COMPACT)
+    {
+        rc = sok_G2_compact(Q, x, xQ, omega, omega_len, x_ni->e, &x_ni->d);
+    }
+    else
+    {
+        rc = sok_G2(Q, x, xQ, omega, omega_len, &x_ni->Rho, &x_ni->d);
+    }
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+
+    // eq_ni_X <-- NIPoK(x : xP <-- x * P and xQ <-- x * Q)
+    if(x_eq_ni != NULL)
+    {
+        return eq_nipok_G1_G2(P, xP, Q, xQ, x, &x_eq_ni->Rho, &x_eq_ni->Sigma, &x_eq_ni->d);
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Finish a x_ni or y_ni signature of knowledge from the nonce of a precomputed ephemeral
+ */
+static int xy_ni_precomp(int format, mclBnG2 * Q, Ephemeral * eph, unsigned char * omega, size_t omega_len, XY_ni * xy_ni)
+{
+
+    xy_ni->format = format;
+    if(format == POK_FORMAT_COMPACT)
+    {
+        return sok_G2_compact_precomp(Q, &eph->x, &eph->xQ, omega, omega_len, &eph->r, &eph->rQ, xy_ni->e, &xy_ni->d);
+    }
+
+    xy_ni->Rho = eph->rQ;
+    return sok_G2_precomp(Q, &eph->x, &eph->xQ, omega, omega_len, &eph->r, &eph->rQ, &xy_ni->d);
+
+}
+
+/*
+ * Same as ake_a_get_mx in pairing mode, with x, xP, xQ and the nonce of x_ni taken from a pool
+ * Only the hash over omega and one Fr multiply-add are left on the interactive path
+ * pool : pool started with P and Q
+ * return : LIKE_OK or an error status
+ */
+int ake_a_get_mx_pooled(int format, EphemeralPool * pool, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni)
+{
+
+    int rc;
+    Ephemeral eph;
+
+    rc = pool_get(pool, &eph);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+    *x = eph.x;
+    *xP = eph.xP;
+    *xQ = eph.xQ;
+
+    // ni_X <-- SoK_omega(x : xQ <-- x * Q)
+    rc = xy_ni_precomp(format, &pool->Q, &eph, omega, omega_len, x_ni);
+
+    ephemeral_clear(&eph);
+
+    return rc;
+
+}
+
+/*
+ * Verify a x_ni or y_ni signature of knowledge in its own format
+ * return : 1 if success
+ */
+static int verify_xy_ni(mclBnG2 * Q, mclBnG2 * xyQ, unsigned char * omega, size_t omega_len, XY_ni * xy_ni)
+{
+
+    if(xy_ni->format == POK_FORMAT_COMPACT)
+    {
+        return sokver_G2_compact(Q, xyQ, xy_ni->e, &xy_ni->d, omega, omega_len);
+    }
+
+    return sokver_G2(Q, xyQ, &xy_ni->Rho, &xy_ni->d, omega, omega_len);
+
+}
+
+/*
+ * Get the lines of xQ kept in the session, computed on first use
+ * They are computed again if xQ no longer matches them
+ * return : the lines, or NULL without memory for them
+ */
+static G2_Lines * like_session_xQ_lines(LikeSession * session)
+{
+
+    G2_Lines * L = &session->xQ_lines;
+
+    if(L->lines == NULL || mclBnG2_isEqual(&L->base, &session->xQ) == 0)
+    {
+        g2_lines_free(L);
+        if(g2_lines_init(L, &session->xQ) != LIKE_OK)
+        {
+            return NULL;
+        }
+    }
+
+    return L;
+
+}
+
+/*
+ * Check e(xP, Q) == e(P, xQ) as e(xP, Q) * e(-P, xQ) == 1, one Miller loop over the lines of Q and of xQ
+ * The lines of xQ stay in the session for ake_b_get_shared_key, without memory for them pairing_product is used
+ * return : 1 if success
+ */
+static int like_session_check_xQ(mclBnG1 * P, mclBnG2 * Q, LikeSession * session)
+{
+
+    mclBnG1 P_neg;
+    mclBnG1 pairing_P[2];
+    mclBnG2 pairing_Q[2];
+    G2_Lines * L = like_session_xQ_lines(session);
+
+    mclBnG1_neg(&P_neg, P);
+    if(L != NULL)
+    {
+        return pairing_lines_is_one(&session->xP, Q, &P_neg, L);
+    }
+
+    pairing_P[0] = session->xP;
+    pairing_P[1] = P_neg;
+    pairing_Q[0] = *Q;
+    pairing_Q[1] = session->xQ;
+
+    return pairing_product_is_one(pairing_P, pairing_Q, 2);
+
+}
+
+/*
+ * session : session holding omega, xP, xQ and x_ni, the lines of xQ are kept in it
+ * x_eq_ni : proof attached by ake_a_get_mx, if not NULL it is checked instead of e(xP, Q) == e(P, xQ)
+ * return : LIKE_OK or LIKE_ERR_VERIFY
+ */
+int verify_mx(mclBnG1 * P, mclBnG2 * Q, LikeSession * session, X_eq_ni * x_eq_ni)
+{
+
+    if(verify_xy_ni(Q, &session->xQ, session->omega, session->omega_len, &session->x_ni) != 1)
+    {
+        fprintf(stderr, "Verify mx failed --> verify ni_x failed\n");
+        return LIKE_ERR_VERIFY;
+    }
+
+    if(x_eq_ni != NULL)
+    {
+        if(eq_nipokver_G1_G2(P, &session->xP, Q, &session->xQ, &x_eq_ni->Rho, &x_eq_ni->Sigma, &x_eq_ni->d) != 1)
+        {
+            fprintf(stderr, "Verify mx failed --> verify eq_ni_x failed\n");
+            return LIKE_ERR_VERIFY;
+        }
+        return LIKE_OK;
+    }
+
+    // e(xP, Q) * e(-P, xQ) == 1, one final exponentiation instead of two
+    if(like_session_check_xQ(P, Q, session) != 1)
+    {
+        fprintf(stderr, "Verify mx failed --> e(xP, Q) =/= e(P, xQ)\n");
+        return LIKE_ERR_VERIFY;
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * format : POK_FORMAT_COMMIT for a (Rho, d) y_ni or POK_FORMAT_COMPACT for a (e, d) y_ni
+ * return : LIKE_OK or an error status
+ */
+int ake_b_get_my(int format, mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni)
+{
+
+    int rc;
+
+    // y <-$- Fr
+    rc = mclBnFr_setByCSPRNG(y);
+    if(rc != 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+    }
+
+    // yQ <-- y * Q
+    G2_mul_gen(yQ, Q, y);
+
+    // ni_Y <-- SoK_omega(y : yQ <-- y * Q)
+    y_ni->format = format;
+    if(format == POK_FORMAT_COMPACT)
+    {
+        return sok_G2_compact(Q, y, yQ, omega, omega_len, y_ni->e, &y_ni->d);
+    }
+
+    return sok_G2(Q, y, yQ, omega, omega_len, &y_ni->Rho, &y_ni->d);
+
+}
+
+/*
+ * Same as ake_b_get_my, with y, yQ and the nonce of y_ni taken from a pool
+ * pool : pool started with Q, P is not needed
+ * return : LIKE_OK or an error status
+ */
+int ake_b_get_my_pooled(int format, EphemeralPool * pool, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni)
+{
+
+    int rc;
+    Ephemeral eph;
+
+    rc = pool_get(pool, &eph);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+    *y = eph.x;
+    *yQ = eph.xQ;
+
+    // ni_Y <-- SoK_omega(y : yQ <-- y * Q)
+    rc = xy_ni_precomp(format, &pool->Q, &eph, omega, omega_len, y_ni);
+
+    ephemeral_clear(&eph);
+
+    return rc;
+
+}
+
+/*
+ * return : LIKE_OK or LIKE_ERR_VERIFY
+ */
+int verify_my(mclBnG2 * Q, mclBnG2 * yQ, unsigned char * omega, size_t omega_len, XY_ni * y_ni)
+{
+
+    if(verify_xy_ni(Q, yQ, omega, omega_len, y_ni) != 1)
+    {
+        fprintf(stderr, "Verify my failed --> verify ni_y failed\n");
+        return LIKE_ERR_VERIFY;
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Verify the x_ni or y_ni signatures of knowledge of n sessions at once, on the operator side
+ * Unlike verify_mx and verify_my, the failed sessions are reported in res, all of them when the batch can not be set up
+ * Compact signatures cannot be batched and are verified one by one
+ * Q : Base point of the G2 elliptic curve group
+ * n : number of sessions
+ * xyQ : array of n pointers to xQ or yQ
+ * xy_ni : array of n pointers to x_ni or y_ni
+ * omega : array of the n sessions omega
+ * omega_len : array of the n omega lengths
+ * res : array of n int to receive 1 for each valid session and 0 for each invalid one
+ * return : 1 if all sessions are valid
+ */
+int verify_mxy_batch(mclBnG2 * Q, size_t n, mclBnG2 ** xyQ, XY_ni ** xy_ni, unsigned char ** omega, size_t * omega_len, int * res)
+{
+
+    int result = 1;
+    size_t nb_batch = 0;
+    mclBnG2 ** Q_ptr = (mclBnG2 **) malloc(n * sizeof(mclBnG2 *));
+    mclBnG2 ** xyQ_batch = (mclBnG2 **) malloc(n * sizeof(mclBnG2 *));
+    mclBnG2 ** Rho = (mclBnG2 **) malloc(n * sizeof(mclBnG2 *));
+    mclBnFr ** d = (mclBnFr **) malloc(n * sizeof(mclBnFr *));
+    unsigned char ** omega_batch = (unsigned char **) malloc(n * sizeof(unsigned char *));
+    size_t * omega_len_batch = (size_t *) malloc(n * sizeof(size_t));
+    size_t * index = (size_t *) malloc(n * sizeof(size_t));
+    int * res_batch = (int *) malloc(n * sizeof(int));
+    if(Q_ptr == NULL || xyQ_batch == NULL || Rho == NULL || d == NULL || omega_batch == NULL || omega_len_batch == NULL || index == NULL || res_batch == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        for(size_t i = 0; res != NULL && i < n; i++)
+        {
+            res[i] = 0;
+        }
+        result = 0;
+        goto err;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if(xy_ni[i]->format == POK_FORMAT_COMPACT)
+        {
+            int valid = sokver_G2_compact(Q, xyQ[i], xy_ni[i]->e, &xy_ni[i]->d, omega[i], omega_len[i]);
+            if(res != NULL)
+            {
+                res[i] = valid;
+            }
+            result &= valid;
+            continue;
+        }
+        Q_ptr[nb_batch] = Q;
+        xyQ_batch[nb_batch] = xyQ[i];
+        Rho[nb_batch] = &xy_ni[i]->Rho;
+        d[nb_batch] = &xy_ni[i]->d;
+        omega_batch[nb_batch] = omega[i];
+        omega_len_batch[nb_batch] = omega_len[i];
+        index[nb_batch] = i;
+        nb_batch++;
+    }
+
+    if(nb_batch > 0)
+    {
+        result &= sokver_G2_batch(nb_batch, Q_ptr, xyQ_batch, Rho, d, omega_batch, omega_len_batch, res_batch);
+        if(res != NULL)
+        {
+            for(size_t i = 0; i < nb_batch; i++)
+            {
+                res[index[i]] = res_batch[i];
+            }
+        }
+    }
+
+    err:
+        free(Q_ptr);
+        free(xyQ_batch);
+        free(Rho);
+        free(d);
+        free(omega_batch);
+        free(omega_len_batch);
+        free(index);
+        free(res_batch);
+
+    return result;
+
+}
+
+/*
+ * Get the length of the serialized omega||mx||my prefix of the AKE messages
+ * omega_len : length of omega
+ * x_ni, y_ni : signatures of knowledge of mx and my, their format sets their length
+ * return : length of the prefix in bytes
+ */
+static size_t get_ake_mxy_len(size_t omega_len, XY_ni * x_ni, XY_ni * y_ni)
+{
+
+    size_t serialize_len_G1 = mclBn_getG1ByteSize();
+    size_t serialize_len_G2 = serialize_len_G1 * 2;
+    size_t serialize_len_Fr = mclBn_getFrByteSize();
+    size_t x_ni_len = (x_ni->format == POK_FORMAT_COMPACT) ? CHALLENGE_LENGTH : serialize_len_G2;
+    size_t y_ni_len = (y_ni->format == POK_FORMAT_COMPACT) ? CHALLENGE_LENGTH : serialize_len_G2;
+
+    return omega_len + serialize_len_G1 + (serialize_len_G2 * 2) + x_ni_len + y_ni_len + (serialize_len_Fr * 2);
+
+}
+
+/*
+ * Serialize the Rho commitment of a x_ni or y_ni signature, or its challenge e if the signature is compact
+ * return : number of bytes written, 0 on error
+ */
+static size_t serialize_xy_ni_commitment(unsigned char * buffer, XY_ni * xy_ni)
+{
+
+    size_t rc;
+
+    if(xy_ni->format == POK_FORMAT_COMPACT)
+    {
+        memcpy(buffer, xy_ni->e, CHALLENGE_LENGTH);
+        return CHALLENGE_LENGTH;
+    }
+
+    rc = mclBnG2_serialize(buffer, mclBn_getG1ByteSize() * 2, &xy_ni->Rho);
+    if(rc == 0)
+    {
+        fprintf(stderr, "Error with mclBnG2_serialize\n");
+    }
+
+    return rc;
+
+}
+
+/*
+ * Init an AKE session, the points xP, xQ, x_ni, yQ, y_ni are then set by ake_a_get_mx and ake_b_get_my
+ * or copied from the received messages, before the first sigma function is called
+ * session : session to init, must be freed with like_session_free
+ * sig_mode : LIKE_SIG_TRANSCRIPT to sign the whole transcript at each step,
+ *            LIKE_SIG_CHAINED to sign h_k <-- H(h_k-1||sigma_k-1) with h_0 <-- H(omega||mx||my)
+ * omega : omega of the session, kept by reference
+ * omega_len : length of omega
+ * sig_len : length of one signature
+ * return : LIKE_OK or LIKE_ERR_MALLOC
+ */
+int like_session_init(LikeSession * session, int sig_mode, unsigned char * omega, size_t omega_len, size_t sig_len)
+{
+
+    size_t serialize_len_G1 = mclBn_getG1ByteSize();
+    size_t serialize_len_G2 = serialize_len_G1 * 2;
+    size_t serialize_len_Fr = mclBn_getFrByteSize();
+
+    session->sig_mode = sig_mode;
+    session->omega = omega;
+    session->omega_len = omega_len;
+    session->sig_len = sig_len;
+    session->mxy_len = 0;
+    session->has_xy_pairing = 0;
+    session->xQ_lines.lines = NULL;
+    session->transcript = (unsigned char *) malloc(omega_len + serialize_len_G1 + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + (sig_len * 3));
+    if(session->transcript == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return LIKE_ERR_MALLOC;
     }
 
-    mclBnG1_mul(lambda_pk, P, lambda_sk);
+    return LIKE_OK;
+
+}
+
+/*
+ * Drop the serialized transcript, the cached e(xP, yQ) and the lines of xQ,
+ * to call when the points of the session have changed : the transcript is not checked against them
+ */
+void like_session_reset(LikeSession * session)
+{
+
+    session->mxy_len = 0;
+    session->has_xy_pairing = 0;
+    g2_lines_free(&session->xQ_lines);
+
+}
+
+/*
+ * Free the transcript buffer and the lines of a session
+ */
+void like_session_free(LikeSession * session)
+{
+
+    free(session->transcript);
+    session->transcript = NULL;
+    session->mxy_len = 0;
+    session->has_xy_pairing = 0;
+    g2_lines_free(&session->xQ_lines);
+
+}
+
+/*
+ * Get e(xP, yQ) of the session, the pairing is computed the first time only and kept while xP and yQ stay the same
+ * xy_pairing : buffer of GT object to receive e(xP, yQ)
+ */
+void like_session_get_xy_pairing(LikeSession * session, mclBnGT * xy_pairing)
+{
+
+    if(session->has_xy_pairing == 0 || mclBnG1_isEqual(&session->xy_xP, &session->xP) == 0 || mclBnG2_isEqual(&session->xy_yQ, &session->yQ) == 0)
+    {
+        mclBn_pairing(&session->xy_pairing, &session->xP, &session->yQ);
+        session->xy_xP = session->xP;
+        session->xy_yQ = session->yQ;
+        session->has_xy_pairing = 1;
+    }
 
-    nipok_G1(P, lambda_sk, lambda_pk, &lambda_ni->Rho, &lambda_ni->d);
+    *xy_pairing = session->xy_pairing;
 
 }
 
 /*
- *
+ * Serialize omega||xP||xQ||x_ni||yQ||y_ni into the transcript of the session, only the first time it is called
+ * return : LIKE_OK or an error status, the transcript is then left unset
  */
-void verify_L_ni(mclBnG1 * P, int nb_args, ...)
+static int like_session_serialize(LikeSession * session)
 {
 
-    va_list list;
-    mclBnG1 * Li_pk;
-    Lambda_ni * li_ni;
+    size_t rc;
+    size_t offset = 0;
+    size_t serialize_len_G1 = mclBn_getG1ByteSize();
+    size_t serialize_len_G2 = serialize_len_G1 * 2;
+    size_t serialize_len_Fr = mclBn_getFrByteSize();
+    unsigned char * buffer = session->transcript;
+    mclBnG2 * points[4] = {&session->xQ, &session->yQ};
+    size_t nb_points = 2;
+
+    if(session->mxy_len != 0)
+    {
+        return LIKE_OK;
+    }
+
+    // One inversion for all the G2 points of the transcript
+    if(session->x_ni.format == POK_FORMAT_COMMIT)
+    {
+        points[nb_points++] = &session->x_ni.Rho;
+    }
+    if(session->y_ni.format == POK_FORMAT_COMMIT)
+    {
+        points[nb_points++] = &session->y_ni.Rho;
+    }
+    G2_normalize_batch(points, nb_points);
+
+    memcpy(buffer, session->omega, session->omega_len);
+    offset += session->omega_len;
 
-    va_start(list, nb_args);
+    rc = mclBnG1_serialize(buffer + offset, serialize_len_G1, &session->xP);
+    if(rc == 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnG1_serialize");
+    }
+    offset += rc;
+    rc = mclBnG2_serialize(buffer + offset, serialize_len_G2, &session->xQ);
+    if(rc == 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnG2_serialize");
+    }
+    offset += rc;
+    rc = serialize_xy_ni_commitment(buffer + offset, &session->x_ni);
+    if(rc == 0)
+    {
+        return LIKE_ERR_MCL;
+    }
+    offset += rc;
+    rc = mclBnFr_serialize(buffer + offset, serialize_len_Fr, &session->x_ni.d);
+    if(rc == 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_serialize");
+    }
+    offset += rc;
+    rc = mclBnG2_serialize(buffer + offset, serialize_len_G2, &session->yQ);
+    if(rc == 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnG2_serialize");
+    }
+    offset += rc;
+    rc = serialize_xy_ni_commitment(buffer + offset, &session->y_ni);
+    if(rc == 0)
+    {
+        return LIKE_ERR_MCL;
+    }
+    offset += rc;
+    rc = mclBnFr_serialize(buffer + offset, serialize_len_Fr, &session->y_ni.d);
+    if(rc == 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_serialize");
+    }
+    offset += rc;
+
+    if(offset != get_ake_mxy_len(session->omega_len, &session->x_ni, &session->y_ni))
+    {
+        fprintf(stderr, "Error with the serialization of the AKE transcript\n");
+        return LIKE_ERR_MCL;
+    }
+
+    if(session->sig_mode == LIKE_SIG_CHAINED)
+    {
+        Transcript t;
+        int status;
+        transcript_init(&t);
+        transcript_absorb_bytes(&t, session->transcript, offset);
+        status = transcript_get_hash(&t, session->mxy_digest);
+        if(status != LIKE_OK)
+        {
+            return status;
+        }
+    }
+
+    session->mxy_len = offset;
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Get the AKE message omega||mx||my||sigma_Y_1||sigma_X||sigma_Y_2 from the transcript of the session
+ * sigma_Y_1, sigma_X, sigma_Y_2 : signatures to append, the message stops at the first NULL one
+ * m_len : receives the length of the message, stored at the start of session->transcript
+ * return : LIKE_OK or an error status
+ */
+static int like_session_get_msg(LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t * m_len)
+{
+
+    int rc;
+    size_t offset;
+    unsigned char * sigs[3] = {sigma_Y_1, sigma_X, sigma_Y_2};
+
+    rc = like_session_serialize(session);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+    offset = session->mxy_len;
+
+    for(int i = 0; i < 3 && sigs[i] != NULL; i++)
+    {
+        memcpy(session->transcript + offset, sigs[i], session->sig_len);
+        offset += session->sig_len;
+    }
+
+    *m_len = offset;
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Get the running digest h_k of the session for LIKE_SIG_CHAINED
+ * h_0 <-- H(omega||mx||my), h_1 <-- H(h_0||sigma_Y_1), h_2 <-- H(h_1||sigma_X), h_3 <-- H(h_2||sigma_Y_2)
+ * sigma_Y_1, sigma_X, sigma_Y_2 : signatures to chain, the chain stops at the first NULL one
+ * digest : buffer of LIKE_DIGEST_LENGTH bytes to receive the digest
+ * return : LIKE_OK or an error status
+ */
+static int like_session_get_digest(LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, unsigned char * digest)
+{
+
+    int rc;
+    Transcript t;
+    unsigned char * sigs[3] = {sigma_Y_1, sigma_X, sigma_Y_2};
+
+    rc = like_session_serialize(session);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+    memcpy(digest, session->mxy_digest, LIKE_DIGEST_LENGTH);
+
+    for(int i = 0; i < 3 && sigs[i] != NULL; i++)
+    {
+        transcript_init(&t);
+        transcript_absorb_bytes(&t, digest, LIKE_DIGEST_LENGTH);
+        transcript_absorb_bytes(&t, sigs[i], session->sig_len);
+        rc = transcript_get_hash(&t, digest);
+        if(rc != LIKE_OK)
+        {
+            return rc;
+        }
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Get the message signed at a step of the AKE, the transcript or its running digest depending on the session mode
+ * m : receives a pointer to the message, in the session or in digest
+ * m_len : receives the length of the message
+ * digest : buffer of LIKE_DIGEST_LENGTH bytes used in LIKE_SIG_CHAINED
+ * return : LIKE_OK or an error status
+ */
+static int like_session_get_signed_msg(LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, unsigned char ** m, size_t * m_len, unsigned char * digest)
+{
+
+    if(session->sig_mode == LIKE_SIG_CHAINED)
+    {
+        *m = digest;
+        *m_len = LIKE_DIGEST_LENGTH;
+        return like_session_get_digest(session, sigma_Y_1, sigma_X, sigma_Y_2, digest);
+    }
+
+    *m = session->transcript;
+    return like_session_get_msg(session, sigma_Y_1, sigma_X, sigma_Y_2, m_len);
+
+}
+
+/*
+ * priv_key : ed25519 private key of B, loaded by ed25519_key_load_priv
+ * return : LIKE_OK or an error status
+ */
+int ake_b_get_sigma_Y_1(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1)
+{
+
+    int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
+    size_t sig_len = session->sig_len;
+
+    rc = like_session_get_signed_msg(session, NULL, NULL, NULL, &m, &m_len, digest);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+
+    // Sign concated data
+    return ssig_ed25519_key(priv_key, m, m_len, &sigma_Y_1, &sig_len);
+
+}
+
+/*
+ * pub_key : ed25519 public key of B, loaded by ed25519_key_load_pub
+ * return : LIKE_OK, LIKE_ERR_VERIFY or an error status
+ */
+int verify_sigma_Y_1(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1)
+{
+
+    int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
+
+    rc = like_session_get_signed_msg(session, NULL, NULL, NULL, &m, &m_len, digest);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
+
+    // Verify sig
+    return sver_ed25519_key(pub_key, m, m_len, sigma_Y_1, session->sig_len);
+
+}
+
+/*
+ * Reset the counters of an operator
+ */
+void verify_stats_init(VerifyStats * stats)
+{
+
+    stats->nb_checked = 0;
+    stats->nb_accepted = 0;
+    for(int i = 0; i < LIKE_NB_STAGES; i++)
+    {
+        stats->nb_rejected[i] = 0;
+    }
+
+}
+
+/*
+ * return : 1 if the format of a x_ni or y_ni is known and its Rho is a valid point
+ */
+static int xy_ni_is_well_formed(XY_ni * xy_ni)
+{
+
+    if(xy_ni->format == POK_FORMAT_COMPACT)
+    {
+        return 1;
+    }
+
+    return xy_ni->format == POK_FORMAT_COMMIT && mclBnG2_isValid(&xy_ni->Rho) == 1;
+
+}
+
+/*
+ * Operator checks of mx, my and sigma_Y_1, ordered by cost so that a forged message is rejected before the pairings
+ * Accepts the same messages as verify_mx, verify_my and verify_sigma_Y_1 together, the stages stop at the first failure :
+ * LIKE_STAGE_FORMAT : lengths, proof formats and points
+ * LIKE_STAGE_SIG : sigma_Y_1, which covers all the points of the session
+ * LIKE_STAGE_SCHNORR : x_ni and y_ni in one batch, then x_eq_ni
+ * LIKE_STAGE_PAIRING : e(xP, Q) == e(P, xQ), only when there is no x_eq_ni
+ * stats : counters of the operator, the stage of each rejection is counted, not shared between threads
+ * pub_key : ed25519 public key of B, loaded by ed25519_key_load_pub
+ * x_eq_ni : proof attached by ake_a_get_mx, NULL to check the pairings
+ * return : LIKE_OK, LIKE_ERR_VERIFY or an error status
+ */
+int ake_O_verify_mxy(VerifyStats * stats, Ed25519Key * pub_key, mclBnG1 * P, mclBnG2 * Q, LikeSession * session, unsigned char * sigma_Y_1, X_eq_ni * x_eq_ni)
+{
+
+    int rc = LIKE_ERR_VERIFY;
+    int stage;
+    mclBnG2 * xyQ[2] = {&session->xQ, &session->yQ};
+    XY_ni * xy_ni[2] = {&session->x_ni, &session->y_ni};
+    unsigned char * omega[2] = {session->omega, session->omega};
+    size_t omega_len[2] = {session->omega_len, session->omega_len};
+
+    stats->nb_checked++;
+
+    stage = LIKE_STAGE_FORMAT;
+    if(session->sig_len != ED25519_SIG_LENGTH || session->omega_len == 0
+        || xy_ni_is_well_formed(&session->x_ni) == 0 || xy_ni_is_well_formed(&session->y_ni) == 0
+        || mclBnG1_isValid(&session->xP) != 1 || mclBnG1_isZero(&session->xP) == 1
+        || mclBnG2_isValid(&session->xQ) != 1 || mclBnG2_isZero(&session->xQ) == 1
+        || mclBnG2_isValid(&session->yQ) != 1 || mclBnG2_isZero(&session->yQ) == 1)
+    {
+        goto err;
+    }
+    if(x_eq_ni != NULL && (mclBnG1_isValid(&x_eq_ni->Rho) != 1 || mclBnG2_isValid(&x_eq_ni->Sigma) != 1))
+    {
+        goto err;
+    }
+
+    stage = LIKE_STAGE_SIG;
+    rc = verify_sigma_Y_1(pub_key, session, sigma_Y_1);
+    if(rc != LIKE_OK)
+    {
+        goto err;
+    }
+
+    stage = LIKE_STAGE_SCHNORR;
+    rc = LIKE_ERR_VERIFY;
+    if(verify_mxy_batch(Q, 2, xyQ, xy_ni, omega, omega_len, NULL) != 1)
+    {
+        goto err;
+    }
+    if(x_eq_ni != NULL && eq_nipokver_G1_G2(P, &session->xP, Q, &session->xQ, &x_eq_ni->Rho, &x_eq_ni->Sigma, &x_eq_ni->d) != 1)
+    {
+        goto err;
+    }
 
-    for(int i = 0; i < (nb_args / 2); i++)
+    // e(xP, Q) * e(-P, xQ) == 1
+    if(x_eq_ni == NULL)
     {
-        Li_pk = va_arg(list, mclBnG1 *);
-        li_ni = va_arg(list, Lambda_ni *);
-        if(nipokver_G1(P, Li_pk, &li_ni->Rho, &li_ni->d) != 1)
+        stage = LIKE_STAGE_PAIRING;
+        if(like_session_check_xQ(P, Q, session) != 1)
         {
-            fprintf(stderr, "NIZKP verification failed\n");
-            exit(EXIT_FAILURE);
+            goto err;
         }
     }
 
-    va_end(list);
+    stats->nb_accepted++;
+
+    return LIKE_OK;
+
+    err:
+        stats->nb_rejected[stage]++;
+
+    return rc;
 
 }
 
 /*
- *
+ * priv_key : ed25519 private key of A, loaded by ed25519_key_load_priv
+ * return : LIKE_OK or an error status
  */
-void ake_precalc_add_lipk(mclBnG1 * L_pk, int nb_args, ...)
+int ake_a_get_sigma_X(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X)
 {
 
-    va_list list;
-    mclBnG1 * Li_pk_current;
-    mclBnG1 * Li_pk_next;
-
-    va_start(list, nb_args);
-
-    Li_pk_current = va_arg(list, mclBnG1 *);
+    int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
+    size_t sig_len = session->sig_len;
 
-    for(int i = 0; i < nb_args - 1; i++)
+    rc = like_session_get_signed_msg(session, sigma_Y_1, NULL, NULL, &m, &m_len, digest);
+    if(rc != LIKE_OK)
     {
-        Li_pk_next = va_arg(list, mclBnG1 *);
-        mclBnG1_add(L_pk, Li_pk_current, Li_pk_next);
-        Li_pk_current = Li_pk_next;
+        return rc;
     }
 
-    va_end(list);
+    // Sign concated data
+    return ssig_ed25519_key(priv_key, m, m_len, &sigma_X, &sig_len);
 
 }
 
 /*
+ * pub_key : ed25519 public key of A, loaded by ed25519_key_load_pub
+ * return : LIKE_OK, LIKE_ERR_VERIFY or an error status
  */
-void ake_a_get_mx(mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni) 
+int verify_sigma_X(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X)
 {
 
     int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
 
-    // r <-$- Fr
-    rc = mclBnFr_setByCSPRNG(x);
-    if(rc != 0)
+    rc = like_session_get_signed_msg(session, sigma_Y_1, NULL, NULL, &m, &m_len, digest);
+    if(rc != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+        return rc;
     }
 
-    // xP <-- x * P
-    mclBnG1_mul(xP, P, x);
-
-    // xQ <-- x * Q
-    mclBnG2_mul(xQ, Q, x);
-
-    // ni_X <-- SoK_omega(x : xQ <-- x * Q)
-    sok_G2(Q, x, xQ, omega, omega_len, &x_ni->Rho, &x_ni->d);
+    // Verify sig
+    return sver_ed25519_key(pub_key, m, m_len, sigma_X, session->sig_len);
 
 }
 
 /*
- *
+ * priv_key : ed25519 private key of B, loaded by ed25519_key_load_priv
+ * return : LIKE_OK or an error status
  */
-void verify_mx(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, unsigned char * omega, size_t omega_len, XY_ni * x_ni) 
+int ake_b_get_sigma_Y_2(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2)
 {
 
-    mclBnGT e1, e2;
+    int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
+    size_t sig_len = session->sig_len;
 
-    if(sokver_G2(Q, xQ, &x_ni->Rho, &x_ni->d, omega, omega_len) != 1 )
+    rc = like_session_get_signed_msg(session, sigma_Y_1, sigma_X, NULL, &m, &m_len, digest);
+    if(rc != LIKE_OK)
     {
-        fprintf(stderr, "Verify mx failed --> verify ni_x failed\n");
-        exit(EXIT_FAILURE);
+        return rc;
     }
 
-    mclBn_pairing(&e1, xP, Q);
-    mclBn_pairing(&e2, P, xQ);
-    if(mclBnGT_isEqual(&e1, &e2) != 1)
-    {
-        fprintf(stderr, "Verify mx failed --> e(xP, Q) =/= e(P, xQ)\n");
-        exit(EXIT_FAILURE);
-    }
+    // Sign concated data
+    return ssig_ed25519_key(priv_key, m, m_len, &sigma_Y_2, &sig_len);
 
 }
 
 /*
+ * pub_key : ed25519 public key of B, loaded by ed25519_key_load_pub
+ * return : LIKE_OK, LIKE_ERR_VERIFY or an error status
  */
-void ake_b_get_my(mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni)
+int verify_sigma_Y_2(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2)
 {
 
     int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
 
-    // y <-$- Fr
-    rc = mclBnFr_setByCSPRNG(y);
-    if(rc != 0)
+    rc = like_session_get_signed_msg(session, sigma_Y_1, sigma_X, NULL, &m, &m_len, digest);
+    if(rc != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+        return rc;
     }
 
-    // yQ <-- y * Q
-    mclBnG2_mul(yQ, Q, y);
-
-    // ni_Y <-- SoK_omega(y : yQ <-- y * Q)
-    sok_G2(Q, y, yQ, omega, omega_len, &y_ni->Rho, &y_ni->d);
+    // Verify
+    return sver_ed25519_key(pub_key, m, m_len, sigma_Y_2, session->sig_len);
 
 }
 
 /*
+ * Build the fixed-base table of L_pk used by ake_a_get_shared_key and ake_b_get_shared_key, called by aggregate_key_sync
+ * The table belongs to the caller, who frees it with fb_G1_free
+ * L_pk_table : table to build, its base is set to L_pk even if the table can not be allocated
+ * L_pk : aggregated authorities public key from ake_precalc_add_lipk
+ * return : LIKE_OK or LIKE_ERR_MALLOC, the shared keys are then computed without the table
  */
-void verify_my(mclBnG2 * Q, mclBnG2 * yQ, unsigned char * omega, size_t omega_len, XY_ni * y_ni)
+int ake_precalc_L_pk_table(FB_G1 * L_pk_table, mclBnG1 * L_pk)
 {
 
-    if(sokver_G2(Q, yQ, &y_ni->Rho, &y_ni->d, omega, omega_len) != 1)
-    {
-        fprintf(stderr, "Verify my failed --> verify ni_y failed\n");
-        exit(EXIT_FAILURE);
-    }
+    return fb_G1_init(L_pk_table, L_pk, LIKE_FB_WINDOW);
 
 }
 
 /*
+ * Multiply the aggregated key by a scalar, with its table when it was built for the current authority set
+ * z : buffer of G1 object to receive z <-- k * L_pk
  */
-void ake_b_get_sigma_Y_1(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1, size_t sig_len)
+static void L_pk_mul(mclBnG1 * z, AggregateKey * agg, mclBnFr * k)
 {
-    
-    int rc;
 
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
+    if(agg->table.table != NULL && agg->table_epoch == agg->epoch)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        fb_G1_mul(z, &agg->table, k);
     }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
+    else
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        mclBnG1_mul(z, &agg->L_pk, k);
     }
 
-    // Concat data
-    size_t buffer_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 16, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr);
-    
-
-    // Sign concated data
-    ssig_ed25519(priv_key_path, buffer, buffer_len, &sigma_Y_1, &sig_len);
-
 }
 
 /*
+ * Start an aggregated key from the current authority set, at epoch 1 and without table
+ * agg : aggregated key to init, kept across sessions and updated as the authority set changes
+ * n : number of authorities
+ * Li_pk : array of the n authorities public keys
  */
-void verify_sigma_Y_1(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1, size_t sig_len)
+void aggregate_key_init(AggregateKey * agg, size_t n, mclBnG1 * Li_pk)
 {
 
-    int rc;
-
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-
-    // Concat data
-    size_t buffer_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 16, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr);
-    
-
-    // Verify sig
-    sver_ed25519(pub_key_path, buffer, buffer_len, sigma_Y_1, sig_len);
+    ake_precalc_add_lipk(&agg->L_pk, n, Li_pk);
+    agg->epoch = 1;
+    agg->table_epoch = 0;
+    agg->table.table = NULL;
 
 }
 
 /*
+ * Add an authority to the set, L_pk <-- L_pk + Li_pk
  */
-void ake_a_get_sigma_X(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, size_t sig_len)
+void aggregate_key_add(AggregateKey * agg, mclBnG1 * Li_pk)
 {
 
-    int rc;
-
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-
-    // Concat data
-    size_t buffer_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len + sig_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 18, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr,
-                    sigma_Y_1, sig_len);
-    
-
-    // Sign concated data
-    ssig_ed25519(priv_key_path, buffer, buffer_len, &sigma_X, &sig_len);
+    mclBnG1_add(&agg->L_pk, &agg->L_pk, Li_pk);
+    agg->epoch++;
 
 }
 
 /*
+ * Remove an authority from the set, L_pk <-- L_pk - Li_pk
  */
-void verify_sigma_X(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, size_t sig_len)
+void aggregate_key_remove(AggregateKey * agg, mclBnG1 * Li_pk)
 {
 
-    int rc;
+    mclBnG1_sub(&agg->L_pk, &agg->L_pk, Li_pk);
+    agg->epoch++;
 
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
+}
 
-    // Concat data
-    size_t buffer_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len + sig_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 18, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr,
-                    sigma_Y_1, sig_len);
-    
+/*
+ * Replace the key of an authority, L_pk <-- L_pk - old_Li_pk + new_Li_pk
+ */
+void aggregate_key_rotate(AggregateKey * agg, mclBnG1 * old_Li_pk, mclBnG1 * new_Li_pk)
+{
 
-    // Verify sig
-    sver_ed25519(pub_key_path, buffer, buffer_len, sigma_X, sig_len);
+    mclBnG1_sub(&agg->L_pk, &agg->L_pk, old_Li_pk);
+    mclBnG1_add(&agg->L_pk, &agg->L_pk, new_Li_pk);
+    agg->epoch++;
 
 }
 
 /*
+ * Build the fixed-base table of L_pk if the authority set changed since the last call, to call before the shared keys
+ * The table is kept in agg and the previous one is freed : no thread may derive a shared key with agg meanwhile
+ * return : LIKE_OK or LIKE_ERR_MALLOC, the shared keys are then computed without the table
  */
-void ake_b_get_sigma_Y_2(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len)
+int aggregate_key_sync(AggregateKey * agg)
 {
 
     int rc;
 
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
+    if(agg->table_epoch == agg->epoch)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return LIKE_OK;
     }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
+
+    fb_G1_free(&agg->table);
+    rc = ake_precalc_L_pk_table(&agg->table, &agg->L_pk);
+    if(rc == LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        agg->table_epoch = agg->epoch;
     }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-
-    // Concat data
-    size_t buffer_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len + (sig_len * 2);
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 20, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr,
-                    sigma_Y_1, sig_len,
-                    sigma_X, sig_len);
-    
 
-    // Sign concated data
-    ssig_ed25519(priv_key_path, buffer, buffer_len, &sigma_Y_2, &sig_len);
+    return rc;
 
 }
 
 /*
+ * Free the fixed-base table of an aggregated key, which can then be synced again
  */
-void verify_sigma_Y_2(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len)
+void aggregate_key_free(AggregateKey * agg)
 {
 
-    int rc;
-
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-
-    // Concat data
-    size_t buffer_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len + (sig_len * 2);
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 20, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr,
-                    sigma_Y_1, sig_len,
-                    sigma_X, sig_len);
-    
-
-    // Verify
-    sver_ed25519(pub_key_path, buffer, buffer_len, sigma_Y_2, sig_len);
+    fb_G1_free(&agg->table);
+    agg->table_epoch = 0;
 
 }
 
-/* 
+/*
+ * ka <-- e(x * L_pk, yQ) = e(L_pk, yQ)^x
+ * The scalar goes on the G1 side, a G1 multiplication being cheaper than an exponentiation in GT
+ * L_pk : aggregated authorities key, its table is used if aggregate_key_sync was called since the last change of the authority set
+ * Only reads L_pk, threads can share it while it is not changed or synced
  */
-void ake_a_get_shared_key(mclBnG1 * L_pk, mclBnG2 * yQ, mclBnFr * x, mclBnGT * ka)
+void ake_a_get_shared_key(AggregateKey * L_pk, LikeSession * session, mclBnFr * x, mclBnGT * ka)
 {
 
-    // ka <-- e(Lamda.pk, yQ)
-    mclBn_pairing(ka, L_pk, yQ);
+    mclBnG1 xL_pk;
 
-    // ka <-- e(Lamda.pk, yQ)^x
-    mclBnGT_pow(ka, ka, x);
+    // xL_pk <-- x * Lamda.pk
+    L_pk_mul(&xL_pk, L_pk, x);
+
+    // ka <-- e(x * Lamda.pk, yQ)
+    mclBn_pairing(ka, &xL_pk, &session->yQ);
 
 }
 
 /*
+ * kb <-- e(y * L_pk, xQ) = e(L_pk, xQ)^y
+ * The pairing uses the lines of xQ kept in the session by verify_mx
+ * L_pk : aggregated authorities key, its table is used if aggregate_key_sync was called since the last change of the authority set
+ * Only reads L_pk, threads can share it while it is not changed or synced
  */
-void ake_b_get_shared_key(mclBnG1 * L_pk, mclBnG2 * xQ, mclBnFr * y, mclBnGT * kb)
+void ake_b_get_shared_key(AggregateKey * L_pk, LikeSession * session, mclBnFr * y, mclBnGT * kb)
 {
 
-    // kb <-- e(Lamda.pk, xQ)
-    mclBn_pairing(kb, L_pk, xQ);
+    mclBnG1 yL_pk;
+
+    // yL_pk <-- y * Lamda.pk
+    L_pk_mul(&yL_pk, L_pk, y);
 
-    // kb <-- e(Lamda.pk, xQ)^y
-    mclBnGT_pow(kb, kb, y);
+    // kb <-- e(y * Lamda.pk, xQ)
+    if(like_session_xQ_lines(session) == NULL)
+    {
+        mclBn_pairing(kb, &yL_pk, &session->xQ);
+        return;
+    }
+    pairing_lines(kb, &yL_pk, &session->xQ_lines);
 
 }
 
 /*
+ * priv_key : ed25519 private key of O, loaded by ed25519_key_load_priv
+ * sst : receives the whole transcript omega||mx||my||sigma_Y_1||sigma_X||sigma_Y_2 and sigma_O, to free by the caller, both left NULL on error
+ * In LIKE_SIG_CHAINED sigma_O signs the final digest h_3, which is computed again from sst->m
+ * return : LIKE_OK or an error status
  */
-void ake_O_get_sst(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, SST * sst)
+int ake_O_get_sst(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, SST * sst)
 {
 
     int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
+    size_t sig_len = session->sig_len;
 
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
+    sst->m = NULL;
+    sst->sigma_O = NULL;
+
+    rc = like_session_get_signed_msg(session, sigma_Y_1, sigma_X, sigma_Y_2, &m, &m_len, digest);
+    if(rc == LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        rc = like_session_get_msg(session, sigma_Y_1, sigma_X, sigma_Y_2, &sst->m_len);
     }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
+    if(rc != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return rc;
     }
 
-    // Concat data
-    sst->m_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len + (sig_len * 3);
+    // Copy the whole transcript, the sst outlives the session and is audited and opened from it alone
     sst->m = (unsigned char *) malloc(sst->m_len * sizeof(unsigned char));
-    concat_arrays(sst->m, 22, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr,
-                    sigma_Y_1, sig_len,
-                    sigma_X, sig_len,
-                    sigma_Y_2, sig_len);
-    
 
     // Allocate sst
     sst->sigma_O_len = sig_len;
     sst->sigma_O = (unsigned char *) malloc(sig_len * sizeof(unsigned char));
+    if(sst->m == NULL || sst->sigma_O == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        rc = LIKE_ERR_MALLOC;
+        goto err;
+    }
+    memcpy(sst->m, session->transcript, sst->m_len);
 
-    // Sign concated data
-    ssig_ed25519(priv_key_path, sst->m, sst->m_len, &sst->sigma_O, &sig_len);
+    // Sign the transcript, or h_3 in LIKE_SIG_CHAINED
+    rc = ssig_ed25519_key(priv_key, m, m_len, &sst->sigma_O, &sig_len);
+    if(rc != LIKE_OK)
+    {
+        goto err;
+    }
+
+    return LIKE_OK;
+
+    err:
+        free(sst->m);
+        free(sst->sigma_O);
+        sst->m = NULL;
+        sst->sigma_O = NULL;
+
+    return rc;
 
 }
 
 /*
+ * pub_key : ed25519 public key of O, loaded by ed25519_key_load_pub
+ * return : LIKE_OK, LIKE_ERR_VERIFY or an error status
  */
-void verify_sst(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, SST * sst)
+int verify_sst(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, SST * sst)
 {
 
     int rc;
+    unsigned char * m;
+    size_t m_len;
+    unsigned char digest[LIKE_DIGEST_LENGTH];
 
-    // Serialize mcl ec pairing objects
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    size_t serialize_len_Fr = mclBn_getFrByteSize();
-    unsigned char mx_xP_bytes[serialize_len_G1];
-    unsigned char mx_xQ_bytes[serialize_len_G2];
-    unsigned char mx_Rho_bytes[serialize_len_G2];
-    unsigned char mx_d_bytes[serialize_len_Fr];
-    unsigned char my_yQ_bytes[serialize_len_G2];
-    unsigned char my_Rho_bytes[serialize_len_G2];
-    unsigned char my_d_bytes[serialize_len_Fr];
-    rc  = mclBnG1_serialize(mx_xP_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_xQ_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(mx_Rho_bytes, serialize_len_G2, &x_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(mx_d_bytes, serialize_len_Fr, &x_ni->d);
-    if(rc == 0)
+    rc = like_session_get_signed_msg(session, sigma_Y_1, sigma_X, sigma_Y_2, &m, &m_len, digest);
+    if(rc != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return rc;
     }
-    rc  = mclBnG2_serialize(my_yQ_bytes, serialize_len_G2, yQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(my_Rho_bytes, serialize_len_G2, &y_ni->Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnFr_serialize(my_d_bytes, serialize_len_Fr, &y_ni->d);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-
-    // Concat data
-    size_t m_len = (serialize_len_G1) + (serialize_len_G2 * 4) + (serialize_len_Fr * 2) + omega_len + (sig_len * 3);
-    unsigned char m[m_len];
-    concat_arrays(m, 22, 
-                    omega, omega_len,
-                    mx_xP_bytes, serialize_len_G1,
-                    mx_xQ_bytes, serialize_len_G2,
-                    mx_Rho_bytes, serialize_len_G2,
-                    mx_d_bytes, serialize_len_Fr,
-                    my_yQ_bytes, serialize_len_G2,
-                    my_Rho_bytes, serialize_len_G2,
-                    my_d_bytes, serialize_len_Fr,
-                    sigma_Y_1, sig_len,
-                    sigma_X, sig_len,
-                    sigma_Y_2, sig_len);
-    
 
     // Verify
-    sver_ed25519(pub_key_path, m, m_len, sst->sigma_O, sig_len);
+    return sver_ed25519_key(pub_key, m, m_len, sst->sigma_O, session->sig_len);
 
 }
 
 /*
+ * Compute the first part of the trapdoor of each authority
+ * session : session of the trapdoor, e(xP, yQ) is computed once and kept in it
+ * n : number of authorities
+ * li_sk : array of the n authorities secret keys
+ * li_T1 : array of n GT objects to receive li_T1 <-- e(xP, yQ)^li_sk
  */
-void tdgen_get_li_T1(mclBnG1 * xP, mclBnG2 * yQ, int nb_args, ...)
+void tdgen_get_li_T1(LikeSession * session, size_t n, mclBnFr * li_sk, mclBnGT * li_T1)
 {
 
-    va_list list;
-    mclBnFr * l_sk;
-    mclBnGT * l_t1;
+    mclBnGT pairing_res;
 
-    va_start(list, nb_args);
+    like_session_get_xy_pairing(session, &pairing_res);
 
-    for(int i = 0; i < (nb_args / 2); i++)
+    for(size_t i = 0; i < n; i++)
     {
-        l_sk = va_arg(list, mclBnFr *);
-        l_t1 = va_arg(list, mclBnGT *);
-        mclBn_pairing(l_t1, xP, yQ);
-        mclBnGT_pow(l_t1, l_t1, l_sk);
+        mclBnGT_pow(&li_T1[i], &pairing_res, &li_sk[i]);
     }
 
-    va_end(list);
-
 }
 
 /*
+ * Compute the proof of each authority that li_T1 and Li_pk share the same discrete log
+ * session : session of the trapdoor, its cached e(xP, yQ) is reused
+ * n : number of authorities
+ * Li_pk, li_sk, li_T1 : arrays of the n authorities public keys, secret keys and li_T1
+ * li_T2 : array of n Lambda_eq_ni to receive the proofs
+ * return : LIKE_OK or an error status
  */
-void tdgen_get_li_T2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, int nb_args, ...)
+int tdgen_get_li_T2(mclBnG1 * P, LikeSession * session, size_t n, mclBnG1 * Li_pk, mclBnFr * li_sk, mclBnGT * li_T1, Lambda_eq_ni * li_T2)
 {
 
+    int rc;
     mclBnGT pairing_res;
 
-    va_list list;
-    mclBnG1 * li_pk;
-    mclBnFr * li_sk;
-    mclBnGT * li_T1;
-    Lambda_eq_ni * li_T2;
-    
-    va_start(list, nb_args);
+    like_session_get_xy_pairing(session, &pairing_res);
 
-    for(int i = 0; i < (nb_args / 4); i++)
+    for(size_t i = 0; i < n; i++)
     {
-        li_pk = va_arg(list, mclBnG1 *);
-        li_sk = va_arg(list, mclBnFr *);
-        li_T1 = va_arg(list, mclBnGT *);
-        li_T2 = va_arg(list, Lambda_eq_ni *);
-        mclBn_pairing(&pairing_res, xP, yQ);
-        eq_nipok_G1_GT(P, li_pk, &pairing_res, li_T1, li_sk, &li_T2->Rho, &li_T2->Sigma, &li_T2->d);
+        li_T2[i].version = LAMBDA_EQ_NI_VERSION;
+        rc = eq_nipok_G1_GT(li_T2[i].version, P, &Li_pk[i], &pairing_res, &li_T1[i], &li_sk[i], &li_T2[i].Rho, &li_T2[i].Sigma, &li_T2[i].d);
+        if(rc != LIKE_OK)
+        {
+            return rc;
+        }
     }
 
-    va_end(list);
+    return LIKE_OK;
 
 }
 
 /*
+ * Verify the li_T2 proofs of the authorities one by one, each one is a 2-term multi-exponentiation in GT
+ * session : session of the trapdoor, its cached e(xP, yQ) is reused
+ * n : number of authorities
+ * Li_pk, li_T1, li_T2 : arrays of the n authorities public keys, li_T1 and li_T2
+ * return : LIKE_OK or LIKE_ERR_VERIFY if one of them is invalid
  */
-void verify_li_T2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, int nb_args, ...)
+int verify_li_T2(mclBnG1 * P, LikeSession * session, size_t n, mclBnG1 * Li_pk, mclBnGT * li_T1, Lambda_eq_ni * li_T2)
 {
 
     mclBnGT pairing_res;
-    mclBn_pairing(&pairing_res, xP, yQ);
-
-    va_list list;
-    mclBnG1 * li_pk;
-    mclBnGT * li_T1;
-    Lambda_eq_ni * li_T2;
+    int result = LIKE_OK;
 
-    va_start(list, nb_args);
+    like_session_get_xy_pairing(session, &pairing_res);
 
-    for(int i = 0; i < (nb_args / 3); i++)
+    for(size_t i = 0; i < n; i++)
     {
-        li_pk = va_arg(list, mclBnG1 *);
-        li_T1 = va_arg(list, mclBnGT *);
-        li_T2 = va_arg(list, Lambda_eq_ni *);
-        if(eq_nipokver_G1_GT(P, li_pk, &pairing_res, li_T1, &li_T2->Rho, &li_T2->Sigma, &li_T2->d) != 1)
+        if(eq_nipokver_G1_GT(li_T2[i].version, P, &Li_pk[i], &pairing_res, &li_T1[i], &li_T2[i].Rho, &li_T2[i].Sigma, &li_T2[i].d) != 1)
         {
-            fprintf(stderr, "verify_li_T2 failed\n");
-            exit(EXIT_FAILURE);
+            fprintf(stderr, "verify_li_T2 failed for authority %zu\n", i);
+            result = LIKE_ERR_VERIFY;
         }
     }
 
-    va_end(list);
+    return result;
 
 }
 
 /*
+ * Recover the shared key from the li_T1 of all the authorities
+ * k : buffer of GT object to receive k <-- li_T1[0] * ... * li_T1[n-1]
+ * n : number of authorities
+ * li_T1 : array of the n authorities li_T1
  */
-void open_get_shared_key(mclBnGT * k, int nb_args, ...)
+void open_get_shared_key(mclBnGT * k, size_t n, mclBnGT * li_T1)
 {
-    
-    va_list list;
 
-    mclBnGT * l_t1;
-    mclBnGT * l_t1_next;
+    mclBnGT_setInt(k, 1);
 
-    va_start(list, nb_args);
-
-    l_t1 = va_arg(list, mclBnGT *);
-    for(int i = 0; i < (nb_args - 1); i++)
+    for(size_t i = 0; i < n; i++)
     {
-        l_t1_next = va_arg(list, mclBnGT *);
-        mclBnGT_mul(k, l_t1, l_t1_next);
-        l_t1 = l_t1_next;
+        mclBnGT_mul(k, k, &li_T1[i]);
     }
 
-    va_end(list);
-
 }
@@ -0,0 +1,384 @@
+#include <stdlib.h>
+
+#include "bn512.h"
+#include "normalize.h"
+
+// Coordinates used by mcl for the points, found by normalize_init
+#define NORMALIZE_GENERIC 0 // unknown, each point is normalized by mcl
+#define NORMALIZE_JACOBI 1 // (X, Y, Z) is (X / Z^2, Y / Z^3)
+#define NORMALIZE_PROJ 2 // (X, Y, Z) is (X / Z, Y / Z)
+
+static int mode_G1 = NORMALIZE_GENERIC;
+static int mode_G2 = NORMALIZE_GENERIC;
+
+/*
+ * Set a G1 point to affine coordinates from the inverse of its Z
+ */
+static void G1_to_affine(mclBnG1 * P, mclBnFp * zinv, int mode)
+{
+
+    mclBnFp t;
+
+    if(mode == NORMALIZE_JACOBI)
+    {
+        mclBnFp_sqr(&t, zinv);
+        mclBnFp_mul(&P->x, &P->x, &t);
+        mclBnFp_mul(&t, &t, zinv);
+        mclBnFp_mul(&P->y, &P->y, &t);
+    }
+    else
+    {
+        mclBnFp_mul(&P->x, &P->x, zinv);
+        mclBnFp_mul(&P->y, &P->y, zinv);
+    }
+    mclBnFp_setInt(&P->z, 1);
+
+}
+
+/*
+ * Set a G2 point to affine coordinates from the inverse of its Z
+ */
+static void G2_to_affine(mclBnG2 * Q, mclBnFp2 * zinv, int mode)
+{
+
+    mclBnFp2 t;
+
+    if(mode == NORMALIZE_JACOBI)
+    {
+        mclBnFp2_sqr(&t, zinv);
+        mclBnFp2_mul(&Q->x, &Q->x, &t);
+        mclBnFp2_mul(&t, &t, zinv);
+        mclBnFp2_mul(&Q->y, &Q->y, &t);
+    }
+    else
+    {
+        mclBnFp2_mul(&Q->x, &Q->x, zinv);
+        mclBnFp2_mul(&Q->y, &Q->y, zinv);
+    }
+    mclBnFp_setInt(&Q->z.d[0], 1);
+    mclBnFp_clear(&Q->z.d[1]);
+
+}
+
+/*
+ * return : 1 if a G1 point is neither zero nor already affine
+ */
+static int G1_needs_normalize(mclBnG1 * P)
+{
+
+    return mclBnFp_isZero(&P->z) == 0 && mclBnFp_isOne(&P->z) == 0;
+
+}
+
+/*
+ * return : 1 if a G2 point is neither zero nor already affine
+ */
+static int G2_needs_normalize(mclBnG2 * Q)
+{
+
+    return mclBnFp2_isZero(&Q->z) == 0 && (mclBnFp_isOne(&Q->z.d[0]) == 0 || mclBnFp_isZero(&Q->z.d[1]) == 0);
+
+}
+
+/*
+ * Find the coordinates of mcl by normalizing 2 * P both ways
+ * return : NORMALIZE_JACOBI, NORMALIZE_PROJ or NORMALIZE_GENERIC if none of them matches mclBnG1_normalize
+ */
+static int G1_detect_mode(mclBnG1 * P)
+{
+
+    mclBnG1 T, ref, tmp;
+    mclBnFp zinv;
+
+    mclBnG1_dbl(&T, P);
+    if(G1_needs_normalize(&T) == 0)
+    {
+        return NORMALIZE_GENERIC;
+    }
+    mclBnG1_normalize(&ref, &T);
+    mclBnFp_inv(&zinv, &T.z);
+
+    for(int mode = NORMALIZE_JACOBI; mode <= NORMALIZE_PROJ; mode++)
+    {
+        tmp = T;
+        G1_to_affine(&tmp, &zinv, mode);
+        if(mclBnFp_isEqual(&tmp.x, &ref.x) && mclBnFp_isEqual(&tmp.y, &ref.y))
+        {
+            return mode;
+        }
+    }
+
+    return NORMALIZE_GENERIC;
+
+}
+
+/*
+ * Same as G1_detect_mode for G2
+ */
+static int G2_detect_mode(mclBnG2 * Q)
+{
+
+    mclBnG2 T, ref, tmp;
+    mclBnFp2 zinv;
+
+    mclBnG2_dbl(&T, Q);
+    if(G2_needs_normalize(&T) == 0)
+    {
+        return NORMALIZE_GENERIC;
+    }
+    mclBnG2_normalize(&ref, &T);
+    mclBnFp2_inv(&zinv, &T.z);
+
+    for(int mode = NORMALIZE_JACOBI; mode <= NORMALIZE_PROJ; mode++)
+    {
+        tmp = T;
+        G2_to_affine(&tmp, &zinv, mode);
+        if(mclBnFp2_isEqual(&tmp.x, &ref.x) && mclBnFp2_isEqual(&tmp.y, &ref.y))
+        {
+            return mode;
+        }
+    }
+
+    return NORMALIZE_GENERIC;
+
+}
+
+/*
+ * Find the coordinates used by mcl, called by setup()
+ * Until then, or if they are not recognized, the batches fall back on one mclBnG1_normalize / mclBnG2_normalize per point
+ * P : Base point of the G1 elliptic curve group
+ * Q : Base point of the G2 elliptic curve group
+ */
+void normalize_init(mclBnG1 * P, mclBnG2 * Q)
+{
+
+    mode_G1 = G1_detect_mode(P);
+    mode_G2 = G2_detect_mode(Q);
+
+}
+
+/*
+ * Set n G1 points to affine coordinates with a single field inversion (Montgomery's simultaneous inversion)
+ * An affine point is serialized without its own inversion, the points are changed in place and keep their value
+ * The zero point and the points already affine are left as they are, a point can be given more than once
+ * P : array of n pointers to the points
+ * n : number of points
+ */
+void G1_normalize_batch(mclBnG1 ** P, size_t n)
+{
+
+    mclBnFp stack_prefix[LIKE_NORMALIZE_STACK];
+    mclBnFp * prefix = stack_prefix;
+    mclBnFp acc, inv;
+    size_t nb = 0;
+
+    if(n > LIKE_NORMALIZE_STACK && mode_G1 != NORMALIZE_GENERIC)
+    {
+        prefix = (mclBnFp *) malloc(n * sizeof(mclBnFp));
+    }
+
+    // Without the coordinates or the memory, one inversion per point
+    if(mode_G1 == NORMALIZE_GENERIC || prefix == NULL)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            mclBnG1_normalize(P[i], P[i]);
+        }
+        return;
+    }
+
+    // prefix[i] <-- Z_0 * ... * Z_i-1
+    mclBnFp_setInt(&acc, 1);
+    for(size_t i = 0; i < n; i++)
+    {
+        prefix[i] = acc;
+        if(G1_needs_normalize(P[i]))
+        {
+            mclBnFp_mul(&acc, &acc, &P[i]->z);
+            nb++;
+        }
+    }
+
+    // Nothing to invert, the points went through a batch already
+    if(nb == 0)
+    {
+        goto end;
+    }
+
+    // prefix[i] <-- 1 / Z_i, the points are not changed yet in case one of them comes twice
+    mclBnFp_inv(&inv, &acc);
+    for(size_t i = n; i-- > 0;)
+    {
+        if(G1_needs_normalize(P[i]))
+        {
+            mclBnFp_mul(&prefix[i], &inv, &prefix[i]);
+            mclBnFp_mul(&inv, &inv, &P[i]->z);
+        }
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if(G1_needs_normalize(P[i]))
+        {
+            G1_to_affine(P[i], &prefix[i], mode_G1);
+        }
+    }
+
+    end:
+        if(prefix != stack_prefix)
+            free(prefix);
+
+}
+
+/*
+ * Same as G1_normalize_batch for G2 points
+ */
+void G2_normalize_batch(mclBnG2 ** Q, size_t n)
+{
+
+    mclBnFp2 stack_prefix[LIKE_NORMALIZE_STACK];
+    mclBnFp2 * prefix = stack_prefix;
+    mclBnFp2 acc, inv;
+    size_t nb = 0;
+
+    if(n > LIKE_NORMALIZE_STACK && mode_G2 != NORMALIZE_GENERIC)
+    {
+        prefix = (mclBnFp2 *) malloc(n * sizeof(mclBnFp2));
+    }
+
+    // Without the coordinates or the memory, one inversion per point
+    if(mode_G2 == NORMALIZE_GENERIC || prefix == NULL)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            mclBnG2_normalize(Q[i], Q[i]);
+        }
+        return;
+    }
+
+    // prefix[i] <-- Z_0 * ... * Z_i-1
+    mclBnFp_setInt(&acc.d[0], 1);
+    mclBnFp_clear(&acc.d[1]);
+    for(size_t i = 0; i < n; i++)
+    {
+        prefix[i] = acc;
+        if(G2_needs_normalize(Q[i]))
+        {
+            mclBnFp2_mul(&acc, &acc, &Q[i]->z);
+            nb++;
+        }
+    }
+
+    // Nothing to invert, the points went through a batch already
+    if(nb == 0)
+    {
+        goto end;
+    }
+
+    // prefix[i] <-- 1 / Z_i, the points are not changed yet in case one of them comes twice
+    mclBnFp2_inv(&inv, &acc);
+    for(size_t i = n; i-- > 0;)
+    {
+        if(G2_needs_normalize(Q[i]))
+        {
+            mclBnFp2_mul(&prefix[i], &inv, &prefix[i]);
+            mclBnFp2_mul(&inv, &inv, &Q[i]->z);
+        }
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if(G2_needs_normalize(Q[i]))
+        {
+            G2_to_affine(Q[i], &prefix[i], mode_G2);
+        }
+    }
+
+    end:
+        if(prefix != stack_prefix)
+            free(prefix);
+
+}
+
+/*
+ * Set out to copies of n G1 points in affine coordinates with a single field inversion
+ * out : array of n G1 objects to receive the copies, must not hold the points
+ * P : array of n pointers to the points
+ * n : number of points
+ */
+void G1_normalize_copy(mclBnG1 * out, mclBnG1 ** P, size_t n)
+{
+
+    mclBnG1 * stack_ptr[LIKE_NORMALIZE_STACK];
+    mclBnG1 ** ptr = stack_ptr;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = *P[i];
+    }
+
+    if(n > LIKE_NORMALIZE_STACK)
+    {
+        ptr = (mclBnG1 **) malloc(n * sizeof(mclBnG1 *));
+    }
+
+    // Without the memory, one inversion per point
+    if(ptr == NULL)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            mclBnG1_normalize(&out[i], &out[i]);
+        }
+        return;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        ptr[i] = &out[i];
+    }
+    G1_normalize_batch(ptr, n);
+
+    if(ptr != stack_ptr)
+        free(ptr);
+
+}
+
+/*
+ * Same as G1_normalize_copy for G2 points
+ */
+void G2_normalize_copy(mclBnG2 * out, mclBnG2 ** Q, size_t n)
+{
+
+    mclBnG2 * stack_ptr[LIKE_NORMALIZE_STACK];
+    mclBnG2 ** ptr = stack_ptr;
+
+    for(size_t i = 0; i < n; i++)
+    {
+        out[i] = *Q[i];
+    }
+
+    if(n > LIKE_NORMALIZE_STACK)
+    {
+        ptr = (mclBnG2 **) malloc(n * sizeof(mclBnG2 *));
+    }
+
+    // Without the memory, one inversion per point
+    if(ptr == NULL)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            mclBnG2_normalize(&out[i], &out[i]);
+        }
+        return;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        ptr[i] = &out[i];
+    }
+    G2_normalize_batch(ptr, n);
+
+    if(ptr != stack_ptr)
+        free(ptr);
+
+}
@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pairing.h"
+#include "bn512.h"
+#include "utils_like.h"
+
+// Lines of the G2 generator, set by setup()
+static G2_Lines lines_Q = {0};
+
+/*
+ * Precompute the Miller loop lines of a fixed G2 point
+ * L : G2_Lines to fill, must be freed with g2_lines_free
+ * Q : G2 point
+ * return : LIKE_OK or LIKE_ERR_MALLOC
+ */
+int g2_lines_init(G2_Lines * L, mclBnG2 * Q)
+{
+
+    L->base = *Q;
+    L->lines = (uint64_t *) malloc(g2_lines_size());
+    if(L->lines == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return LIKE_ERR_MALLOC;
+    }
+
+    mclBn_precomputeG2(L->lines, Q);
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Free the lines of a G2_Lines, can be called on an already freed or zeroed one
+ */
+void g2_lines_free(G2_Lines * L)
+{
+
+    free(L->lines);
+    L->lines = NULL;
+
+}
+
+/*
+ * return : size in bytes of the lines of one G2 point
+ */
+size_t g2_lines_size(void)
+{
+
+    return mclBn_getUint64NumToPrecompute() * sizeof(uint64_t);
+
+}
+
+/*
+ * Compute a pairing whose G2 side has precomputed lines
+ * res : buffer of GT object to receive e(P, L->base)
+ * P : G1 point
+ * L : lines of the G2 point
+ */
+void pairing_lines(mclBnGT * res, mclBnG1 * P, G2_Lines * L)
+{
+
+    mclBnGT f;
+
+    mclBn_precomputedMillerLoop(&f, P, L->lines);
+    mclBn_finalExp(res, &f);
+
+}
+
+/*
+ * Precompute the lines of the G2 generator, used by pairing_product for every pair whose G2 side is Q
+ * Q : Base point of the G2 elliptic curve group
+ * return : LIKE_OK or LIKE_ERR_MALLOC, pairing_product then runs without the lines
+ */
+int pairing_init_generator(mclBnG2 * Q)
+{
+
+    g2_lines_free(&lines_Q);
+
+    return g2_lines_init(&lines_Q, Q);
+
+}
+
+/*
+ * Compute the product of n pairings with a single final exponentiation
+ * The pairs whose G2 side is the generator given to setup() share one Miller loop over its precomputed lines
+ * res : buffer of GT object to receive e(P[0], Q[0]) * ... * e(P[n-1], Q[n-1])
+ * P : array of n G1 points
+ * Q : array of n G2 points
+ * n : number of pairings
+ */
+void pairing_product(mclBnGT * res, mclBnG1 * P, mclBnG2 * Q, size_t n)
+{
+
+    mclBnGT f, f_gen;
+    mclBnG1 P_gen;
+    mclBnG1 * P_other;
+    mclBnG2 * Q_other;
+    size_t nb_gen = 0;
+    size_t nb_other = 0;
+
+    if(lines_Q.lines != NULL)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            nb_gen += mclBnG2_isEqual(&Q[i], &lines_Q.base);
+        }
+    }
+
+    if(nb_gen == 0)
+    {
+        mclBn_millerLoopVec(&f, P, Q, n);
+        mclBn_finalExp(res, &f);
+        return;
+    }
+
+    // Without memory to split the pairs, fall back on the plain Miller loop
+    P_other = (mclBnG1 *) malloc((n - nb_gen + 1) * sizeof(mclBnG1));
+    Q_other = (mclBnG2 *) malloc((n - nb_gen + 1) * sizeof(mclBnG2));
+    if(P_other == NULL || Q_other == NULL)
+    {
+        free(P_other);
+        free(Q_other);
+        mclBn_millerLoopVec(&f, P, Q, n);
+        mclBn_finalExp(res, &f);
+        return;
+    }
+
+    // e(P_1, Q) * ... * e(P_k, Q) = e(P_1 + ... + P_k, Q)
+    mclBnG1_clear(&P_gen);
+    for(size_t i = 0; i < n; i++)
+    {
+        if(mclBnG2_isEqual(&Q[i], &lines_Q.base))
+        {
+            mclBnG1_add(&P_gen, &P_gen, &P[i]);
+        }
+        else
+        {
+            P_other[nb_other] = P[i];
+            Q_other[nb_other] = Q[i];
+            nb_other++;
+        }
+    }
+
+    if(mclBnG1_isZero(&P_gen))
+    {
+        if(nb_other == 0)
+        {
+            mclBnGT_setInt(&f, 1);
+        }
+        else
+        {
+            mclBn_millerLoopVec(&f, P_other, Q_other, nb_other);
+        }
+    }
+    else if(nb_other == 0)
+    {
+        mclBn_precomputedMillerLoop(&f, &P_gen, lines_Q.lines);
+    }
+    else if(nb_other == 1)
+    {
+        mclBn_precomputedMillerLoop2mixed(&f, &P_other[0], &Q_other[0], &P_gen, lines_Q.lines);
+    }
+    else
+    {
+        mclBn_millerLoopVec(&f, P_other, Q_other, nb_other);
+        mclBn_precomputedMillerLoop(&f_gen, &P_gen, lines_Q.lines);
+        mclBnGT_mul(&f, &f, &f_gen);
+    }
+
+    mclBn_finalExp(res, &f);
+
+    free(P_other);
+    free(Q_other);
+
+}
+
+/*
+ * Check that e(P1, Q) * e(P2, L->base) == 1 with a single Miller loop over precomputed lines
+ * The lines of the generator given to setup() are used when Q is the generator, else Q runs a plain Miller loop
+ * P1 : G1 point paired with Q
+ * Q : G2 point, usually the generator
+ * P2 : G1 point paired with the base of L
+ * L : lines of the second G2 point
+ * return : 1 if the product is the identity of GT
+ */
+int pairing_lines_is_one(mclBnG1 * P1, mclBnG2 * Q, mclBnG1 * P2, G2_Lines * L)
+{
+
+    mclBnGT f, res;
+
+    if(lines_Q.lines != NULL && mclBnG2_isEqual(Q, &lines_Q.base))
+    {
+        mclBn_precomputedMillerLoop2(&f, P1, lines_Q.lines, P2, L->lines);
+    }
+    else
+    {
+        mclBn_precomputedMillerLoop2mixed(&f, P1, Q, P2, L->lines);
+    }
+    mclBn_finalExp(&res, &f);
+
+    return mclBnGT_isOne(&res);
+
+}
+
+/*
+ * Check that a product of n pairings is the identity of GT
+ * e(A, B) == e(C, D) is checked as e(A, B) * e(-C, D) == 1
+ * P : array of n G1 points
+ * Q : array of n G2 points
+ * n : number of pairings
+ * return : 1 if e(P[0], Q[0]) * ... * e(P[n-1], Q[n-1]) == 1
+ */
+int pairing_product_is_one(mclBnG1 * P, mclBnG2 * Q, size_t n)
+{
+
+    mclBnGT res;
+
+    pairing_product(&res, P, Q, n);
+
+    return mclBnGT_isOne(&res);
+
+}
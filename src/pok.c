@@ -1,12 +1,46 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-#include <openssl/sha.h>
-
 #include "pok.h"
 #include "bn512.h"
+#include "fixed_base.h"
+#include "transcript.h"
+#include "normalize.h"
 #include "utils_like.h"
 
+/*
+ * Get the challenge of a sok_G2 signature of knowledge
+ * e : buffer of Fr object to receive e <-- H(rho||Q||xQ||msg) mod r
+ * hash : buffer of CHALLENGE_LENGTH bytes to receive H(rho||Q||xQ||msg), can be NULL
+ * return : LIKE_OK or an error status
+ */
+static int sok_G2_challenge(mclBnG2 * Q, mclBnG2 * xQ, mclBnG2 * Rho, unsigned char * msg, size_t msg_len, mclBnFr * e, unsigned char * hash)
+{
+
+    int status;
+    Transcript t;
+    unsigned char hash_tmp[CHALLENGE_LENGTH];
+    mclBnG2 * points[3] = {Rho, Q, xQ};
+
+    transcript_init(&t);
+    transcript_absorb_G2_vec(&t, points, 3);
+    transcript_absorb_bytes(&t, msg, msg_len);
+    status = transcript_get_hash(&t, hash_tmp);
+    if(status != LIKE_OK)
+    {
+        return status;
+    }
+
+    if(hash != NULL)
+    {
+        memcpy(hash, hash_tmp, CHALLENGE_LENGTH);
+    }
+
+    return hash_to_Fr(e, hash_tmp);
+
+}
+
 /*
  * Compute a Signature of knowledge of the message m wih the xQ = x * Q log over the group G2 
  * Use the Shnorr algorithm with Fiat-Shamir heuristic (replace challenge by hash of the message concatenate with points of G2 Q, xQ and Rho)
@@ -17,58 +51,54 @@
  * msg_len : len of the message
  * Rho : buffer pf G2 object to receive Rho <-- rQ
  * d : buffe for Fr object to receive d <-- (e * x) + r
+ * return : LIKE_OK or an error status
  */
-void sok_G2(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnG2 * Rho, mclBnFr * d)
+int sok_G2(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnG2 * Rho, mclBnFr * d)
 {
 
     int rc;
-    mclBnFr r, e;
+    mclBnFr r;
 
     // r <-$- Fr
     rc = mclBnFr_setByCSPRNG(&r);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
     }
 
     // Rho <-- rQ
-    mclBnG2_mul(Rho, Q, &r);
+    G2_mul_gen(Rho, Q, &r);
 
-    // Get H(rho||Q||xQ||msg)
-    size_t serialize_len = mclBn_getG1ByteSize() * 2;
-    unsigned char rho_bytes[serialize_len];
-    unsigned char q_bytes[serialize_len];
-    unsigned char xq_bytes[serialize_len];
-    rc  = mclBnG2_serialize(rho_bytes, serialize_len, Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    rc  = mclBnG2_serialize(q_bytes, serialize_len, Q);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    rc  = mclBnG2_serialize(xq_bytes, serialize_len, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    size_t buffer_len = (serialize_len * 3) + msg_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 8, rho_bytes, serialize_len, q_bytes, serialize_len, xq_bytes, serialize_len, msg, msg_len);
-    unsigned char * hash = sha256(buffer, buffer_len);
+    // e <-- H(rho||Q||xQ||msg) mod r, d <-- (e * x) + r
+    return sok_G2_precomp(Q, x, xQ, msg, msg_len, &r, Rho, d);
+
+}
+
+/*
+ * Finish a sok_G2 signature of knowledge from a nonce drawn in advance, the online part of sok_G2
+ * r : secret nonce in Fr, must not be used for an other signature
+ * Rho : Rho <-- rQ
+ * d : buffe for Fr object to receive d <-- (e * x) + r
+ * return : LIKE_OK or an error status
+ */
+int sok_G2_precomp(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnFr * r, mclBnG2 * Rho, mclBnFr * d)
+{
+
+    int status;
+    mclBnFr e;
 
     // e <-- H(rho||Q||xQ||msg) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
+    status = sok_G2_challenge(Q, xQ, Rho, msg, msg_len, &e, NULL);
+    if(status != LIKE_OK)
+    {
+        return status;
+    }
 
     // d <-- (e * x) + r
     mclBnFr_mul(d, &e, x);
-    mclBnFr_add(d, d, &r);
+    mclBnFr_add(d, d, r);
 
-    free(hash);
-    free(e_str);
+    return LIKE_OK;
 
 }
 
@@ -85,50 +115,334 @@ void sok_G2(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t
 int sokver_G2(mclBnG2 * Q, mclBnG2 * xQ, mclBnG2 * Rho, mclBnFr * d, unsigned char * msg, size_t msg_len)
 {
 
-    int rc;
     mclBnFr e;
-    mclBnG2 A, B;
+    mclBnFr scalars[2];
+    mclBnG2 A;
+    mclBnG2 bases[2];
 
-    // Get H(rho||Q||xQ||msg)
-    size_t serialize_len = mclBn_getG1ByteSize() * 2;
-    unsigned char rho_bytes[serialize_len];
-    unsigned char q_bytes[serialize_len];
-    unsigned char xq_bytes[serialize_len];
-    rc  = mclBnG2_serialize(rho_bytes, serialize_len, Rho);
-    if(rc == 0)
+    // e <-- H(rho||Q||xQ||msg) mod r
+    if(sok_G2_challenge(Q, xQ, Rho, msg, msg_len, &e, NULL) != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
+        return 0;
     }
-    rc  = mclBnG2_serialize(q_bytes, serialize_len, Q);
-    if(rc == 0)
+
+    // A <-- dQ - e(xQ) in a single multi-scalar multiplication
+    bases[0] = *Q;
+    bases[1] = *xQ;
+    scalars[0] = *d;
+    mclBnFr_neg(&scalars[1], &e);
+    mclBnG2_mulVec(&A, bases, scalars, 2);
+
+    // dQ - e(xQ) - Rho == 0
+    return mclBnG2_isEqual(&A, Rho);
+
+}
+
+/*
+ * Compute a sok_G2 signature of knowledge in compact form (e, d) instead of (Rho, d)
+ * The verifier recomputes Rho <-- dQ - e(xQ) and checks that it hashes to e
+ * e : buffer of CHALLENGE_LENGTH bytes to receive e <-- H(rho||Q||xQ||msg)
+ * d : buffer of Fr object to receive d <-- (e * x) + r
+ * return : LIKE_OK or an error status
+ */
+int sok_G2_compact(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, unsigned char * e, mclBnFr * d)
+{
+
+    int rc;
+    mclBnFr r;
+    mclBnG2 Rho;
+
+    // r <-$- Fr
+    rc = mclBnFr_setByCSPRNG(&r);
+    if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
     }
-    rc  = mclBnG2_serialize(xq_bytes, serialize_len, xQ);
-    if(rc == 0)
+
+    // Rho <-- rQ
+    G2_mul_gen(&Rho, Q, &r);
+
+    // e <-- H(rho||Q||xQ||msg), d <-- (e * x) + r
+    return sok_G2_compact_precomp(Q, x, xQ, msg, msg_len, &r, &Rho, e, d);
+
+}
+
+/*
+ * Finish a sok_G2_compact signature of knowledge from a nonce drawn in advance, the online part of sok_G2_compact
+ * r : secret nonce in Fr, must not be used for an other signature
+ * Rho : Rho <-- rQ
+ * e : buffer of CHALLENGE_LENGTH bytes to receive e <-- H(rho||Q||xQ||msg)
+ * d : buffer of Fr object to receive d <-- (e * x) + r
+ * return : LIKE_OK or an error status
+ */
+int sok_G2_compact_precomp(mclBnG2 * Q, mclBnFr * x, mclBnG2 * xQ, unsigned char * msg, size_t msg_len, mclBnFr * r, mclBnG2 * Rho, unsigned char * e, mclBnFr * d)
+{
+
+    int status;
+    mclBnFr e_fr;
+
+    // e <-- H(rho||Q||xQ||msg)
+    status = sok_G2_challenge(Q, xQ, Rho, msg, msg_len, &e_fr, e);
+    if(status != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
+        return status;
+    }
+
+    // d <-- (e * x) + r
+    mclBnFr_mul(d, &e_fr, x);
+    mclBnFr_add(d, d, r);
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Verfify a sok_G2_compact signature of knowledge
+ * Q : Base point of the G2 elliptic curve group
+ * xQ : xQ <-- x * Q
+ * e : e <-- H(rho||Q||xQ||msg) as CHALLENGE_LENGTH bytes
+ * d : d <-- (e * x) + r
+ * return : 1 if success
+ */
+int sokver_G2_compact(mclBnG2 * Q, mclBnG2 * xQ, unsigned char * e, mclBnFr * d, unsigned char * msg, size_t msg_len)
+{
+
+    mclBnFr e_fr;
+    mclBnFr scalars[2];
+    mclBnG2 Rho;
+    mclBnG2 bases[2];
+    unsigned char hash[CHALLENGE_LENGTH];
+
+    // Rho <-- dQ - e(xQ)
+    if(hash_to_Fr(&e_fr, e) != LIKE_OK)
+    {
+        return 0;
+    }
+    bases[0] = *Q;
+    bases[1] = *xQ;
+    scalars[0] = *d;
+    mclBnFr_neg(&scalars[1], &e_fr);
+    mclBnG2_mulVec(&Rho, bases, scalars, 2);
+
+    // H(rho||Q||xQ||msg) == e
+    if(sok_G2_challenge(Q, xQ, &Rho, msg, msg_len, &e_fr, hash) != LIKE_OK)
+    {
+        return 0;
+    }
+
+    return memcmp(hash, e, CHALLENGE_LENGTH) == 0;
+
+}
+
+/*
+ * Reject every element of a batch that could not be checked
+ * res : array of n int set to 0, can be NULL
+ */
+static void batch_reject(int * res, size_t n)
+{
+
+    if(res == NULL)
+    {
+        return;
+    }
+
+    for(size_t i = 0; i < n; i++)
+    {
+        res[i] = 0;
+    }
+
+}
+
+/*
+ * Check the signatures start to start + n - 1 of a sok_G2 batch with a single multi-scalar multiplication
+ * sum (w_i * d_i) * Q_i - sum (w_i * e_i) * xQ_i - sum w_i * Rho_i == 0, the terms of the Q_i equal to Q_0 are merged
+ * e : challenges of the signatures
+ * w : random weights of the signatures
+ * bases, scalars : work arrays of at least 3 * n elements
+ * return : 1 if the combination is zero
+ */
+static int sokver_G2_batch_check(mclBnG2 ** Q, mclBnG2 ** xQ, mclBnG2 ** Rho, mclBnFr ** d, mclBnFr * e, mclBnFr * w, int * same_Q, size_t start, size_t n, mclBnG2 * bases, mclBnFr * scalars)
+{
+
+    size_t j;
+    size_t nb_terms = 1;
+    mclBnFr tmp;
+    mclBnG2 A;
+
+    bases[0] = *Q[0];
+    mclBnFr_clear(&scalars[0]);
+    for(size_t i = 0; i < n; i++)
+    {
+        j = start + i;
+
+        // (w_j * d_j) * Q_j
+        mclBnFr_mul(&tmp, &w[j], d[j]);
+        if(same_Q[j] == 1)
+        {
+            mclBnFr_add(&scalars[0], &scalars[0], &tmp);
+        }
+        else
+        {
+            bases[nb_terms] = *Q[j];
+            scalars[nb_terms] = tmp;
+            nb_terms++;
+        }
+
+        // -(w_j * e_j) * xQ_j
+        bases[nb_terms] = *xQ[j];
+        mclBnFr_mul(&tmp, &w[j], &e[j]);
+        mclBnFr_neg(&scalars[nb_terms], &tmp);
+        nb_terms++;
+
+        // -w_j * Rho_j
+        bases[nb_terms] = *Rho[j];
+        mclBnFr_neg(&scalars[nb_terms], &w[j]);
+        nb_terms++;
+    }
+
+    mclBnG2_mulVec(&A, bases, scalars, nb_terms);
+
+    return mclBnG2_isZero(&A);
+
+}
+
+/*
+ * Find the invalid signatures of a failed sok_G2 batch by bisection
+ * res : array receiving 1 for each valid signature and 0 for each invalid one
+ */
+static void sokver_G2_batch_bisect(mclBnG2 ** Q, mclBnG2 ** xQ, mclBnG2 ** Rho, mclBnFr ** d, mclBnFr * e, mclBnFr * w, int * same_Q, size_t start, size_t n, mclBnG2 * bases, mclBnFr * scalars, int * res)
+{
+
+    if(sokver_G2_batch_check(Q, xQ, Rho, d, e, w, same_Q, start, n, bases, scalars) == 1)
+    {
+        for(size_t i = start; i < start + n; i++)
+        {
+            res[i] = 1;
+        }
+        return;
+    }
+
+    if(n == 1)
+    {
+        res[start] = 0;
+        return;
+    }
+
+    sokver_G2_batch_bisect(Q, xQ, Rho, d, e, w, same_Q, start, n / 2, bases, scalars, res);
+    sokver_G2_batch_bisect(Q, xQ, Rho, d, e, w, same_Q, start + (n / 2), n - (n / 2), bases, scalars, res);
+
+}
+
+/*
+ * Verify a batch of sok_G2 signatures of knowledge at once, typically coming from different sessions
+ * The n equations are combined with random 128 bits weights into a single multi-scalar multiplication
+ * If the batch fails, bisection finds the invalid signatures
+ * n : number of signatures
+ * Q : array of n pointers to the base points, usually all the G2 generator
+ * xQ : array of n pointers to xQ_i <-- x_i * Q_i
+ * Rho : array of n pointers to Rho_i <-- r_i * Q_i
+ * d : array of n pointers to d_i <-- (e_i * x_i) + r_i
+ * msg : array of n signed messages
+ * msg_len : array of the n messages lengths
+ * res : array of n int to receive 1 for each valid signature and 0 for each invalid one, can be NULL to skip the bisection
+ * return : 1 if all signatures are valid, 0 if one is invalid or if the batch could not be checked (all rejected in res)
+ */
+int sokver_G2_batch(size_t n, mclBnG2 ** Q, mclBnG2 ** xQ, mclBnG2 ** Rho, mclBnFr ** d, unsigned char ** msg, size_t * msg_len, int * res)
+{
+
+    int result = 0;
+    int checked = 0;
+
+    if(n == 0)
+    {
+        return 1;
     }
-    size_t buffer_len = (serialize_len * 3) + msg_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 8, rho_bytes, serialize_len, q_bytes, serialize_len, xq_bytes, serialize_len, msg, msg_len);
-    unsigned char * hash = sha256(buffer, buffer_len);
-    
-    // e <-- H(rho||Q||xQ||msg) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
 
-    // A <-- dQ
-    mclBnG2_mul(&A, Q, d);
+    mclBnFr * e = (mclBnFr *) malloc(n * sizeof(mclBnFr));
+    mclBnFr * w = (mclBnFr *) malloc(n * sizeof(mclBnFr));
+    int * same_Q = (int *) malloc(n * sizeof(int));
+    mclBnG2 * bases = (mclBnG2 *) malloc((3 * n) * sizeof(mclBnG2));
+    mclBnFr * scalars = (mclBnFr *) malloc((3 * n) * sizeof(mclBnFr));
+    mclBnG2 * affine = (mclBnG2 *) malloc((2 * n) * sizeof(mclBnG2));
+    if(e == NULL || w == NULL || same_Q == NULL || bases == NULL || scalars == NULL || affine == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        goto err;
+    }
 
-    // B <-- e(xQ) + Rho  
-    mclBnG2_mul(&B, xQ, &e);
-    mclBnG2_add(&B, &B, Rho);
+    // One inversion for all the points hashed by the challenges
+    G2_normalize_copy(affine, xQ, n);
+    G2_normalize_copy(affine + n, Rho, n);
 
-    free(hash);
-    free(e_str);
+    for(size_t i = 0; i < n; i++)
+    {
+        if(sok_G2_challenge(Q[i], &affine[i], &affine[n + i], msg[i], msg_len[i], &e[i], NULL) != LIKE_OK || rand_Fr_128(&w[i]) != LIKE_OK)
+        {
+            goto err;
+        }
+        same_Q[i] = (Q[i] == Q[0]) || mclBnG2_isEqual(Q[i], Q[0]);
+    }
+
+    checked = 1;
+
+    result = sokver_G2_batch_check(Q, xQ, Rho, d, e, w, same_Q, 0, n, bases, scalars);
+    if(res != NULL)
+    {
+        if(result == 1)
+        {
+            for(size_t i = 0; i < n; i++)
+            {
+                res[i] = 1;
+            }
+        }
+        else
+        {
+            sokver_G2_batch_bisect(Q, xQ, Rho, d, e, w, same_Q, 0, n, bases, scalars, res);
+        }
+    }
+
+    err:
+        free(e);
+        free(w);
+        free(same_Q);
+        free(bases);
+        free(scalars);
+        free(affine);
+        if(checked == 0)
+            batch_reject(res, n);
+
+    return result;
+
+}
+
+/*
+ * Get the challenge of a nipok_G1 proof
+ * e : buffer of Fr object to receive e <-- H(rho||P||xP) mod r
+ * hash : buffer of CHALLENGE_LENGTH bytes to receive H(rho||P||xP), can be NULL
+ * return : LIKE_OK or an error status
+ */
+static int nipok_G1_challenge(mclBnG1 * P, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * e, unsigned char * hash)
+{
+
+    int status;
+    Transcript t;
+    unsigned char hash_tmp[CHALLENGE_LENGTH];
+    mclBnG1 * points[3] = {Rho, P, xP};
+
+    transcript_init(&t);
+    transcript_absorb_G1_vec(&t, points, 3);
+    status = transcript_get_hash(&t, hash_tmp);
+    if(status != LIKE_OK)
+    {
+        return status;
+    }
+
+    if(hash != NULL)
+    {
+        memcpy(hash, hash_tmp, CHALLENGE_LENGTH);
+    }
 
-    return mclBnG2_isEqual(&A, &B);
+    return hash_to_Fr(e, hash_tmp);
 
 }
 
@@ -140,8 +454,9 @@ int sokver_G2(mclBnG2 * Q, mclBnG2 * xQ, mclBnG2 * Rho, mclBnFr * d, unsigned ch
  * xP : xP <-- x * P
  * Rho : buffer of G1 object to receive Rho <-- rP
  * d : buffer of Fr object to receive d <-- (e * x) + r
+ * return : LIKE_OK or an error status
  */
-void nipok_G1(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d)
+int nipok_G1(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d)
 {
 
     int rc;
@@ -151,47 +466,24 @@ void nipok_G1(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d
     rc = mclBnFr_setByCSPRNG(&r);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
     }
 
     // Rho <-- rP
-    mclBnG1_mul(Rho, P, &r);
+    G1_mul_gen(Rho, P, &r);
 
-    // Get H(rho||P||xP)
-    size_t serialize_len = mclBn_getG1ByteSize();
-    unsigned char rho_bytes[serialize_len];
-    unsigned char p_bytes[serialize_len];
-    unsigned char xp_bytes[serialize_len];
-    rc  = mclBnG1_serialize(rho_bytes, serialize_len, Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG1_serialize(p_bytes, serialize_len, P);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG1_serialize(xp_bytes, serialize_len, xP);
-    if(rc == 0)
+    // e <-- H(rho||P||xP) mod r
+    rc = nipok_G1_challenge(P, xP, Rho, &e, NULL);
+    if(rc != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return rc;
     }
-    size_t buffer_len = (serialize_len * 3);
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 6, rho_bytes, serialize_len, p_bytes, serialize_len, xp_bytes, serialize_len);
-    unsigned char * hash = sha256(buffer, buffer_len);
-
-    // e <-- H(rho||P||xP) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
 
     // d <-- (e * x) + r
     mclBnFr_mul(d, &e, x);
     mclBnFr_add(d, d, &r);
 
-    free(hash);
-    free(e_str);
+    return LIKE_OK;
 
 }
 
@@ -206,50 +498,248 @@ void nipok_G1(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d
 int nipokver_G1(mclBnG1 * P, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d)
 {
 
-    int rc;
     mclBnFr e;
-    mclBnG1 A, B;
+    mclBnFr scalars[2];
+    mclBnG1 A;
+    mclBnG1 bases[2];
 
-    // Get H(rho||P||xP)
-    size_t serialize_len = mclBn_getG1ByteSize();
-    unsigned char rho_bytes[serialize_len];
-    unsigned char p_bytes[serialize_len];
-    unsigned char xp_bytes[serialize_len];
-    rc  = mclBnG1_serialize(rho_bytes, serialize_len, Rho);
-    if(rc == 0)
+    // e <-- H(rho||P||xP) mod r
+    if(nipok_G1_challenge(P, xP, Rho, &e, NULL) != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return 0;
     }
-    rc  = mclBnG1_serialize(p_bytes, serialize_len, P);
-    if(rc == 0)
+
+    // A <-- dP - e(xP) in a single multi-scalar multiplication
+    bases[0] = *P;
+    bases[1] = *xP;
+    scalars[0] = *d;
+    mclBnFr_neg(&scalars[1], &e);
+    mclBnG1_mulVec(&A, bases, scalars, 2);
+
+    // dP - e(xP) - Rho == 0
+    return mclBnG1_isEqual(&A, Rho);
+
+}
+
+/*
+ * Compute a nipok_G1 proof in compact form (e, d) instead of (Rho, d)
+ * The verifier recomputes Rho <-- dP - e(xP) and checks that it hashes to e
+ * e : buffer of CHALLENGE_LENGTH bytes to receive e <-- H(rho||P||xP)
+ * d : buffer of Fr object to receive d <-- (e * x) + r
+ * return : LIKE_OK or an error status
+ */
+int nipok_G1_compact(mclBnG1 * P, mclBnFr * x, mclBnG1 * xP, unsigned char * e, mclBnFr * d)
+{
+
+    int rc;
+    mclBnFr r, e_fr;
+    mclBnG1 Rho;
+
+    // r <-$- Fr
+    rc = mclBnFr_setByCSPRNG(&r);
+    if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
     }
-    rc  = mclBnG1_serialize(xp_bytes, serialize_len, xP);
-    if(rc == 0)
+
+    // Rho <-- rP
+    G1_mul_gen(&Rho, P, &r);
+
+    // e <-- H(rho||P||xP)
+    rc = nipok_G1_challenge(P, xP, &Rho, &e_fr, e);
+    if(rc != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return rc;
+    }
+
+    // d <-- (e * x) + r
+    mclBnFr_mul(d, &e_fr, x);
+    mclBnFr_add(d, d, &r);
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Verfify a nipok_G1_compact non-interactive zero-knowledge proof
+ * P : Base point of the G1 elliptic curve group
+ * xP : xP <-- x * P
+ * e : e <-- H(rho||P||xP) as CHALLENGE_LENGTH bytes
+ * d : d <-- (e * x) + r
+ * return : 1 if success
+ */
+int nipokver_G1_compact(mclBnG1 * P, mclBnG1 * xP, unsigned char * e, mclBnFr * d)
+{
+
+    mclBnFr e_fr;
+    mclBnFr scalars[2];
+    mclBnG1 Rho;
+    mclBnG1 bases[2];
+    unsigned char hash[CHALLENGE_LENGTH];
+
+    // Rho <-- dP - e(xP)
+    if(hash_to_Fr(&e_fr, e) != LIKE_OK)
+    {
+        return 0;
+    }
+    bases[0] = *P;
+    bases[1] = *xP;
+    scalars[0] = *d;
+    mclBnFr_neg(&scalars[1], &e_fr);
+    mclBnG1_mulVec(&Rho, bases, scalars, 2);
+
+    // H(rho||P||xP) == e
+    if(nipok_G1_challenge(P, xP, &Rho, &e_fr, hash) != LIKE_OK)
+    {
+        return 0;
+    }
+
+    return memcmp(hash, e, CHALLENGE_LENGTH) == 0;
+
+}
+
+/*
+ * Check the proofs start to start + n - 1 of a nipok_G1 batch with a single multi-scalar multiplication
+ * (sum w_i * d_i) * P - sum (w_i * e_i) * xP_i - sum w_i * Rho_i == 0
+ * e : challenges of the proofs
+ * w : random weights of the proofs
+ * bases, scalars : work arrays of at least (2 * n) + 1 elements
+ * return : 1 if the combination is zero
+ */
+static int nipokver_G1_batch_check(mclBnG1 * P, mclBnG1 ** xP, mclBnG1 ** Rho, mclBnFr ** d, mclBnFr * e, mclBnFr * w, size_t start, size_t n, mclBnG1 * bases, mclBnFr * scalars)
+{
+
+    size_t j;
+    mclBnFr tmp;
+    mclBnG1 A;
+
+    bases[0] = *P;
+    mclBnFr_clear(&scalars[0]);
+    for(size_t i = 0; i < n; i++)
+    {
+        j = start + i;
+
+        // scalars[0] <-- scalars[0] + (w_j * d_j)
+        mclBnFr_mul(&tmp, &w[j], d[j]);
+        mclBnFr_add(&scalars[0], &scalars[0], &tmp);
+
+        // -(w_j * e_j) * xP_j
+        bases[1 + i] = *xP[j];
+        mclBnFr_mul(&tmp, &w[j], &e[j]);
+        mclBnFr_neg(&scalars[1 + i], &tmp);
+
+        // -w_j * Rho_j
+        bases[1 + n + i] = *Rho[j];
+        mclBnFr_neg(&scalars[1 + n + i], &w[j]);
+    }
+
+    mclBnG1_mulVec(&A, bases, scalars, (2 * n) + 1);
+
+    return mclBnG1_isZero(&A);
+
+}
+
+/*
+ * Find the invalid proofs of a failed nipok_G1 batch by bisection
+ * res : array receiving 1 for each valid proof and 0 for each invalid one
+ */
+static void nipokver_G1_batch_bisect(mclBnG1 * P, mclBnG1 ** xP, mclBnG1 ** Rho, mclBnFr ** d, mclBnFr * e, mclBnFr * w, size_t start, size_t n, mclBnG1 * bases, mclBnFr * scalars, int * res)
+{
+
+    if(nipokver_G1_batch_check(P, xP, Rho, d, e, w, start, n, bases, scalars) == 1)
+    {
+        for(size_t i = start; i < start + n; i++)
+        {
+            res[i] = 1;
+        }
+        return;
+    }
+
+    if(n == 1)
+    {
+        res[start] = 0;
+        return;
+    }
+
+    nipokver_G1_batch_bisect(P, xP, Rho, d, e, w, start, n / 2, bases, scalars, res);
+    nipokver_G1_batch_bisect(P, xP, Rho, d, e, w, start + (n / 2), n - (n / 2), bases, scalars, res);
+
+}
+
+/*
+ * Verify a batch of nipok_G1 non-interactive zero-knowledge proofs at once
+ * The n equations are combined with random 128 bits weights into a single multi-scalar multiplication
+ * If the batch fails, bisection finds the invalid proofs
+ * P : Base point of the G1 elliptic curve group
+ * n : number of proofs
+ * xP : array of n pointers to xP_i <-- x_i * P
+ * Rho : array of n pointers to Rho_i <-- r_i * P
+ * d : array of n pointers to d_i <-- (e_i * x_i) + r_i
+ * res : array of n int to receive 1 for each valid proof and 0 for each invalid one, can be NULL to skip the bisection
+ * return : 1 if all proofs are valid, 0 if one is invalid or if the batch could not be checked (all rejected in res)
+ */
+int nipokver_G1_batch(mclBnG1 * P, size_t n, mclBnG1 ** xP, mclBnG1 ** Rho, mclBnFr ** d, int * res)
+{
+
+    int result = 0;
+    int checked = 0;
+
+    if(n == 0)
+    {
+        return 1;
     }
-    size_t buffer_len = (serialize_len * 3);
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 6, rho_bytes, serialize_len, p_bytes, serialize_len, xp_bytes, serialize_len);
-    unsigned char * hash = sha256(buffer, buffer_len);
-    
-    // e <-- H(rho||P||xP) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
 
-    // A <-- dP
-    mclBnG1_mul(&A, P, d);
+    mclBnFr * e = (mclBnFr *) malloc(n * sizeof(mclBnFr));
+    mclBnFr * w = (mclBnFr *) malloc(n * sizeof(mclBnFr));
+    mclBnG1 * bases = (mclBnG1 *) malloc(((2 * n) + 1) * sizeof(mclBnG1));
+    mclBnFr * scalars = (mclBnFr *) malloc(((2 * n) + 1) * sizeof(mclBnFr));
+    mclBnG1 * affine = (mclBnG1 *) malloc((2 * n) * sizeof(mclBnG1));
+    if(e == NULL || w == NULL || bases == NULL || scalars == NULL || affine == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        goto err;
+    }
+
+    // One inversion for all the points hashed by the challenges
+    G1_normalize_copy(affine, xP, n);
+    G1_normalize_copy(affine + n, Rho, n);
+
+    for(size_t i = 0; i < n; i++)
+    {
+        if(nipok_G1_challenge(P, &affine[i], &affine[n + i], &e[i], NULL) != LIKE_OK || rand_Fr_128(&w[i]) != LIKE_OK)
+        {
+            goto err;
+        }
+    }
 
-    // B <-- e(xP) + Rho  
-    mclBnG1_mul(&B, xP, &e);
-    mclBnG1_add(&B, &B, Rho);
+    checked = 1;
 
-    free(hash);
-    free(e_str);
+    result = nipokver_G1_batch_check(P, xP, Rho, d, e, w, 0, n, bases, scalars);
+    if(res != NULL)
+    {
+        if(result == 1)
+        {
+            for(size_t i = 0; i < n; i++)
+            {
+                res[i] = 1;
+            }
+        }
+        else
+        {
+            nipokver_G1_batch_bisect(P, xP, Rho, d, e, w, 0, n, bases, scalars, res);
+        }
+    }
 
-    return mclBnG1_isEqual(&A, &B);
+    err:
+        free(e);
+        free(w);
+        free(bases);
+        free(scalars);
+        free(affine);
+        if(checked == 0)
+            batch_reject(res, n);
+
+    return result;
 
 }
 
@@ -264,81 +754,45 @@ int nipokver_G1(mclBnG1 * P, mclBnG1 * xP, mclBnG1 * Rho, mclBnFr * d)
  * Rho : buffer of G1 object to receive Rho <-- rP
  * Sigma : buffer of G2 object to receive Sigma <-- rQ
  * d : buffer of Fr object to receive d <-- (e * x) + r
+ * return : LIKE_OK or an error status
  */
-void eq_nipok_G1_G2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, mclBnFr * x,  mclBnG1 * Rho,  mclBnG2 * Sigma, mclBnFr * d)
+int eq_nipok_G1_G2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, mclBnFr * x,  mclBnG1 * Rho,  mclBnG2 * Sigma, mclBnFr * d)
 {
 
     int rc;
     mclBnFr r, e;
+    Transcript t;
+    mclBnG1 * points_G1[3] = {Rho, P, xP};
+    mclBnG2 * points_G2[3] = {Sigma, Q, xQ};
 
     // r <-$- Fr
     rc = mclBnFr_setByCSPRNG(&r);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
     }   
 
     // Rho <-- rP
-    mclBnG1_mul(Rho, P, &r);
+    G1_mul_gen(Rho, P, &r);
 
     // Sigma <-- rQ
-    mclBnG2_mul(Sigma, Q, &r);
-
-    // Get H(Rho||Sigma||P||Q||xP||xQ)
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    unsigned char rho_bytes[serialize_len_G1];
-    unsigned char p_bytes[serialize_len_G1];
-    unsigned char xp_bytes[serialize_len_G1];
-    unsigned char sigma_bytes[serialize_len_G2];
-    unsigned char q_bytes[serialize_len_G2];
-    unsigned char xq_bytes[serialize_len_G2];
-    rc  = mclBnG1_serialize(rho_bytes, serialize_len_G1, Rho);
-    if(rc == 0)
+    G2_mul_gen(Sigma, Q, &r);
+
+    // e <-- H(Rho||P||xP||Sigma||Q||xQ) mod r
+    transcript_init(&t);
+    transcript_absorb_G1_vec(&t, points_G1, 3);
+    transcript_absorb_G2_vec(&t, points_G2, 3);
+    rc = transcript_get_challenge(&t, &e);
+    if(rc != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
+        return rc;
     }
-    rc  = mclBnG1_serialize(p_bytes, serialize_len_G1, P);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG1_serialize(xp_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(sigma_bytes, serialize_len_G2, Sigma);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    rc  = mclBnG2_serialize(q_bytes, serialize_len_G2, Q);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    rc  = mclBnG2_serialize(xq_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    size_t buffer_len = (serialize_len_G1 * 3) + (serialize_len_G2 * 3);
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 12, rho_bytes, serialize_len_G1, p_bytes, serialize_len_G1, xp_bytes, serialize_len_G1,
-                                          sigma_bytes, serialize_len_G2, q_bytes, serialize_len_G2, xq_bytes, serialize_len_G2);
-    unsigned char * hash = sha256(buffer, buffer_len);
-
-    // e <-- H(Rho||Sigma||P||Q||xP||xQ) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
 
     // d <-- (e * x) + r
     mclBnFr_mul(d, &e, x);
     mclBnFr_add(d, d, &r);
 
-    free(hash);
-    free(e_str);
+    return LIKE_OK;
 
 }
 
@@ -356,84 +810,97 @@ void eq_nipok_G1_G2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, mclBnF
 int eq_nipokver_G1_G2(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, mclBnG1 * Rho,  mclBnG2 * Sigma, mclBnFr * d)
 {
 
-    int rc;
     mclBnFr e;
-    mclBnG1 A1, B1;
-    mclBnG2 A2, B2;
-
-    // Get H(Rho||Sigma||P||Q||xP||xQ)
-    size_t serialize_len_G1 = mclBn_getG1ByteSize();
-    size_t serialize_len_G2 = serialize_len_G1 * 2;
-    unsigned char rho_bytes[serialize_len_G1];
-    unsigned char p_bytes[serialize_len_G1];
-    unsigned char xp_bytes[serialize_len_G1];
-    unsigned char sigma_bytes[serialize_len_G2];
-    unsigned char q_bytes[serialize_len_G2];
-    unsigned char xq_bytes[serialize_len_G2];
-    rc  = mclBnG1_serialize(rho_bytes, serialize_len_G1, Rho);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG1_serialize(p_bytes, serialize_len_G1, P);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG1_serialize(xp_bytes, serialize_len_G1, xP);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG1_serialize");
-    }
-    rc  = mclBnG2_serialize(sigma_bytes, serialize_len_G2, Sigma);
-    if(rc == 0)
+    mclBnFr scalars[2];
+    mclBnG1 A1;
+    mclBnG2 A2;
+    mclBnG1 bases_G1[2];
+    mclBnG2 bases_G2[2];
+    Transcript t;
+    mclBnG1 * points_G1[3] = {Rho, P, xP};
+    mclBnG2 * points_G2[3] = {Sigma, Q, xQ};
+
+    // e <-- H(Rho||P||xP||Sigma||Q||xQ) mod r
+    transcript_init(&t);
+    transcript_absorb_G1_vec(&t, points_G1, 3);
+    transcript_absorb_G2_vec(&t, points_G2, 3);
+    if(transcript_get_challenge(&t, &e) != LIKE_OK)
     {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
+        return 0;
     }
-    rc  = mclBnG2_serialize(q_bytes, serialize_len_G2, Q);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    rc  = mclBnG2_serialize(xq_bytes, serialize_len_G2, xQ);
-    if(rc == 0)
-    {
-        handle_mcl_error(rc, "Error with mclBnG2_serialize");
-    }
-    size_t buffer_len = (serialize_len_G1 * 3) + (serialize_len_G2 * 3);
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 12, rho_bytes, serialize_len_G1, p_bytes, serialize_len_G1, xp_bytes, serialize_len_G1,
-                                          sigma_bytes, serialize_len_G2, q_bytes, serialize_len_G2, xq_bytes, serialize_len_G2);
-    unsigned char * hash = sha256(buffer, buffer_len);
 
-    // e <-- H(Rho||Sigma||P||Q||xP||xQ) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
+    scalars[0] = *d;
+    mclBnFr_neg(&scalars[1], &e);
+
+    // A1 <-- (d * P) - (e * xP)
+    bases_G1[0] = *P;
+    bases_G1[1] = *xP;
+    mclBnG1_mulVec(&A1, bases_G1, scalars, 2);
 
-    // A1 <-- d * P
-    mclBnG1_mul(&A1, P, d);
+    // A2 <-- (d * Q) - (e * xQ)
+    bases_G2[0] = *Q;
+    bases_G2[1] = *xQ;
+    mclBnG2_mulVec(&A2, bases_G2, scalars, 2);
 
-    // B1 <-- (P * e) + Rho
-    mclBnG1_mul(&B1, xP, &e);
-    mclBnG1_add(&B1, &B1, Rho);
+    // A1 - Rho == 0 and A2 - Sigma == 0
+    return mclBnG1_isEqual(&A1, Rho) && mclBnG2_isEqual(&A2, Sigma);
+
+}
+
+/*
+ * Get the challenge of an eq_nipok_G1_GT proof
+ * version : EQ_NIPOK_GT_STR to hash base 16 strings, EQ_NIPOK_GT_BIN to hash serialized elements
+ * e : buffer of Fr object to receive e <-- H(Rho||Sigma||P||pairing_res||Li_pk||li_T1) mod r
+ * return : LIKE_OK or an error status
+ */
+static int eq_nipok_G1_GT_challenge(int version, mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * e)
+{
 
-    // A2 <-- d * Q
-    mclBnG2_mul(&A2, Q, d);
+    Transcript t;
+    mclBnG1 * points[3] = {Rho, P, Li_pk};
+    mclBnG1 affine[3];
 
-    // B2 <-- (e * Q) + Sigma
-    mclBnG2_mul(&B2, xQ, &e);
-    mclBnG2_add(&B2, &B2, Sigma);
+    // One inversion for the three points, serialized one by one between the GT elements
+    G1_normalize_copy(affine, points, 3);
+    Rho = &affine[0];
+    P = &affine[1];
+    Li_pk = &affine[2];
 
-    free(hash);
-    free(e_str);
+    // e <-- H(Rho||Sigma||P||pairing_res||Li_pk||li_T1) mod r
+    transcript_init(&t);
+    if(version == EQ_NIPOK_GT_STR)
+    {
+        transcript_absorb_G1_str(&t, Rho);
+        transcript_absorb_GT_str(&t, sigma);
+        transcript_absorb_G1_str(&t, P);
+        transcript_absorb_GT_str(&t, pairing_res);
+        transcript_absorb_G1_str(&t, Li_pk);
+        transcript_absorb_GT_str(&t, li_T1);
+    }
+    else
+    {
+        transcript_absorb_G1(&t, Rho);
+        transcript_absorb_GT(&t, sigma);
+        transcript_absorb_G1(&t, P);
+        transcript_absorb_GT(&t, pairing_res);
+        transcript_absorb_G1(&t, Li_pk);
+        transcript_absorb_GT(&t, li_T1);
+    }
 
-    return mclBnG1_isEqual(&A1, &B1) && mclBnG2_isEqual(&A2, &B2);
+    return transcript_get_challenge(&t, e);
 
 }
 
 /*
+ * Compute a non-interactive zero-knowledge proof of the equality of the Li_pk = li_sk * P log over the group G1 and the li_T1 = pairing_res^li_sk log over the group GT
+ * Use the Chaum and Pedersen protocol with Fiat-Shamir heuristic
+ * version : encoding of the hashed elements, EQ_NIPOK_GT_STR or EQ_NIPOK_GT_BIN
+ * Rho : buffer of G1 object to receive Rho <-- rP
+ * sigma : buffer of GT object to receive sigma <-- pairing_res^r
+ * d : buffer of Fr object to receive d <-- (e * li_sk) + r
+ * return : LIKE_OK or an error status
  */
-void eq_nipok_G1_GT(mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1, mclBnFr * li_sk,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d)
+int eq_nipok_G1_GT(int version, mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1, mclBnFr * li_sk,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d)
 {
 
     int rc;
@@ -443,122 +910,65 @@ void eq_nipok_G1_GT(mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT
     rc = mclBnFr_setByCSPRNG(&r);
     if(rc != 0)
     {
-        handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
     }   
 
     // Rho <-- rP
-    mclBnG1_mul(Rho, P, &r);
+    G1_mul_gen(Rho, P, &r);
 
     // Sigma <-- rQ
     mclBnGT_pow(sigma, pairing_res, &r);
 
-    // Get H(Rho||Sigma||P||pairing_res||Li_pk||li_T1)
-    char rho_str[4096];
-    size_t rho_str_len = mclBnG1_getStr(rho_str, sizeof(rho_str), Rho, 16);
-
-    char sigma_str[4096];
-    size_t sigma_str_len = mclBnGT_getStr(sigma_str, sizeof(sigma_str), sigma, 16);
-
-    char p_str[4096];
-    size_t p_str_len = mclBnG1_getStr(p_str, sizeof(p_str), P, 16);
-
-    char pairing_res_str[4096];
-    size_t pairing_res_str_len = mclBnGT_getStr(pairing_res_str, sizeof(pairing_res_str), pairing_res, 16);
-    
-    char li_pk_str[4096];
-    size_t li_pk_str_len = mclBnG1_getStr(li_pk_str, sizeof(li_pk_str), Li_pk, 16);
-
-    char li_T1_str[4096];
-    size_t li_T1_str_len = mclBnGT_getStr(li_T1_str, sizeof(li_T1_str), li_T1, 16);
-
-    size_t buffer_len = rho_str_len + sigma_str_len + p_str_len + pairing_res_str_len + li_pk_str_len + li_T1_str_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 12, 
-                        rho_str, rho_str_len,
-                        sigma_str, sigma_str_len,
-                        p_str, p_str_len,
-                        pairing_res_str, pairing_res_str_len,
-                        li_pk_str, li_pk_str_len,
-                        li_T1_str, li_T1_str_len);
-            
-
-    unsigned char * hash = sha256(buffer, buffer_len);
-
-    // e <-- H(Rho||Sigma||P||Q||xP||xQ) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
+    // e <-- H(Rho||Sigma||P||pairing_res||Li_pk||li_T1) mod r
+    rc = eq_nipok_G1_GT_challenge(version, P, Li_pk, pairing_res, li_T1, Rho, sigma, &e);
+    if(rc != LIKE_OK)
+    {
+        return rc;
+    }
 
     // d <-- (e * x) + r
     mclBnFr_mul(d, &e, li_sk);
     mclBnFr_add(d, d, &r);
 
-    free(hash);
-    free(e_str);
+    return LIKE_OK;
 
 }
 
 /*
+ * Verify a eq_nipok_G1_GT non-interactive zero-knowledge proof
+ * version : encoding used by the prover, EQ_NIPOK_GT_STR or EQ_NIPOK_GT_BIN
+ * return : 1 if success
  */
-int eq_nipokver_G1_GT(mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d)
+int eq_nipokver_G1_GT(int version, mclBnG1 * P, mclBnG1 * Li_pk, mclBnGT * pairing_res, mclBnGT * li_T1,  mclBnG1 * Rho,  mclBnGT * sigma, mclBnFr * d)
 {
 
     mclBnFr e;
-    mclBnG1 A1, B1;
-    mclBnGT a2, b2;
-
-    // Get H(Rho||Sigma||P||pairing_res||Li_pk||li_T1)
-    char rho_str[4096];
-    size_t rho_str_len = mclBnG1_getStr(rho_str, sizeof(rho_str), Rho, 16);
-
-    char sigma_str[4096];
-    size_t sigma_str_len = mclBnGT_getStr(sigma_str, sizeof(sigma_str), sigma, 16);
-
-    char p_str[4096];
-    size_t p_str_len = mclBnG1_getStr(p_str, sizeof(p_str), P, 16);
-
-    char pairing_res_str[4096];
-    size_t pairing_res_str_len = mclBnGT_getStr(pairing_res_str, sizeof(pairing_res_str), pairing_res, 16);
-    
-    char li_pk_str[4096];
-    size_t li_pk_str_len = mclBnG1_getStr(li_pk_str, sizeof(li_pk_str), Li_pk, 16);
-
-    char li_T1_str[4096];
-    size_t li_T1_str_len = mclBnGT_getStr(li_T1_str, sizeof(li_T1_str), li_T1, 16);
-
-    size_t buffer_len = rho_str_len + sigma_str_len + p_str_len + pairing_res_str_len + li_pk_str_len + li_T1_str_len;
-    unsigned char buffer[buffer_len];
-    concat_arrays(buffer, 12, 
-                        rho_str, rho_str_len,
-                        sigma_str, sigma_str_len,
-                        p_str, p_str_len,
-                        pairing_res_str, pairing_res_str_len,
-                        li_pk_str, li_pk_str_len,
-                        li_T1_str, li_T1_str_len);
-            
-
-    unsigned char * hash = sha256(buffer, buffer_len);
+    mclBnFr scalars[2];
+    mclBnG1 A1;
+    mclBnGT a2;
+    mclBnG1 bases_G1[2];
+    mclBnGT bases_GT[2];
 
     // e <-- H(Rho||Sigma||P||pairing_res||Li_pk||li_T1) mod r
-    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
-    mclBnFr_setStr(&e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
-
-    // A1 <-- d * P
-    mclBnG1_mul(&A1, P, d);
-
-    // B1 <-- (P * e) + Rho
-    mclBnG1_mul(&B1, Li_pk, &e);
-    mclBnG1_add(&B1, &B1, Rho);
+    if(eq_nipok_G1_GT_challenge(version, P, Li_pk, pairing_res, li_T1, Rho, sigma, &e) != LIKE_OK)
+    {
+        return 0;
+    }
 
-    // a2 <-- pairing_res^(d)
-    mclBnGT_pow(&a2, pairing_res, d);
+    scalars[0] = *d;
+    mclBnFr_neg(&scalars[1], &e);
 
-    // b2 <-- li_T1^(e) + sigma
-    mclBnGT_pow(&b2, li_T1, &e);
-    mclBnGT_mul(&b2, &b2, sigma);
+    // A1 <-- (d * P) - (e * Li_pk)
+    bases_G1[0] = *P;
+    bases_G1[1] = *Li_pk;
+    mclBnG1_mulVec(&A1, bases_G1, scalars, 2);
 
-    free(hash);
-    free(e_str);
+    // a2 <-- pairing_res^(d) * li_T1^(-e) in a single multi-exponentiation
+    bases_GT[0] = *pairing_res;
+    bases_GT[1] = *li_T1;
+    mclBnGT_powVec(&a2, bases_GT, scalars, 2);
 
-    return mclBnG1_isEqual(&A1, &B1) && mclBnGT_isEqual(&a2, &b2);
+    // A1 - Rho == 0 and a2 / sigma == 1
+    return mclBnG1_isEqual(&A1, Rho) && mclBnGT_isEqual(&a2, sigma);
 
 }
@@ -0,0 +1,249 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pool.h"
+#include "bn512.h"
+#include "fixed_base.h"
+#include "utils_like.h"
+
+/*
+ * Overwrite a secret with zeros, through a volatile pointer so the stores are not dropped by the compiler
+ */
+static void secure_zero(void * buf, size_t len)
+{
+
+    volatile unsigned char * p = (volatile unsigned char *) buf;
+
+    while(len--)
+    {
+        *p++ = 0;
+    }
+
+}
+
+/*
+ * Draw an ephemeral key and the nonce of its signature of knowledge, the offline part of ake_a_get_mx / ake_b_get_my
+ * eph : buffer to receive x, xP <-- x * P, xQ <-- x * Q, r and rQ <-- r * Q
+ * P : Base point of the G1 elliptic curve group, NULL to skip xP
+ * Q : Base point of the G2 elliptic curve group
+ * return : LIKE_OK or an error status
+ */
+int ephemeral_gen(Ephemeral * eph, mclBnG1 * P, mclBnG2 * Q)
+{
+
+    int rc;
+
+    // x <-$- Fr, r <-$- Fr
+    rc = mclBnFr_setByCSPRNG(&eph->x);
+    if(rc != 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+    }
+    rc = mclBnFr_setByCSPRNG(&eph->r);
+    if(rc != 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_setByCSPRNG");
+    }
+
+    // xP <-- x * P, xQ <-- x * Q, rQ <-- r * Q
+    if(P != NULL)
+    {
+        G1_mul_gen(&eph->xP, P, &eph->x);
+    }
+    G2_mul_gen(&eph->xQ, Q, &eph->x);
+    G2_mul_gen(&eph->rQ, Q, &eph->r);
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Zeroize an ephemeral, to call once its secrets x and r have been used
+ */
+void ephemeral_clear(Ephemeral * eph)
+{
+
+    secure_zero(eph, sizeof(Ephemeral));
+
+}
+
+/*
+ * Refill thread of a pool, sleeps while the pool is full
+ */
+static void * pool_refill(void * arg)
+{
+
+    int status;
+    EphemeralPool * pool = (EphemeralPool *) arg;
+    Ephemeral eph;
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->stop == 0)
+    {
+        if(pool->count == pool->depth)
+        {
+            pthread_cond_wait(&pool->not_full, &pool->lock);
+            continue;
+        }
+
+        // The scalar multiplications run without the lock
+        pthread_mutex_unlock(&pool->lock);
+        status = ephemeral_gen(&eph, pool->with_P ? &pool->P : NULL, &pool->Q);
+        pthread_mutex_lock(&pool->lock);
+
+        // An other thread may have filled the last slot meanwhile, the extra ephemeral is then dropped
+        if(status == LIKE_OK && pool->stop == 0 && pool->count < pool->depth)
+        {
+            pool->slots[pool->count] = eph;
+            pool->count++;
+            pthread_cond_broadcast(&pool->refilled);
+        }
+        ephemeral_clear(&eph);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+
+}
+
+/*
+ * Start a pool of precomputed ephemerals, refilled in the background as they are consumed
+ * pool : pool to start, must be stopped with pool_free
+ * P : Base point of the G1 elliptic curve group, NULL for a pool of B which has no xP
+ * Q : Base point of the G2 elliptic curve group
+ * depth : number of ephemerals kept ready (LIKE_POOL_DEPTH by default)
+ * nb_threads : number of refill threads (LIKE_POOL_THREADS by default), 0 to compute every ephemeral on demand
+ * return : LIKE_OK, LIKE_ERR_MALLOC or LIKE_ERR_THREAD, the pool is left stopped on error
+ */
+int pool_init(EphemeralPool * pool, mclBnG1 * P, mclBnG2 * Q, size_t depth, size_t nb_threads)
+{
+
+    int rc;
+
+    pool->with_P = (P != NULL);
+    if(P != NULL)
+    {
+        pool->P = *P;
+    }
+    pool->Q = *Q;
+    pool->depth = depth;
+    pool->count = 0;
+    pool->nb_threads = nb_threads;
+    pool->stop = 0;
+
+    pool->slots = (Ephemeral *) malloc(depth * sizeof(Ephemeral));
+    pool->threads = (pthread_t *) malloc(nb_threads * sizeof(pthread_t));
+    if((depth > 0 && pool->slots == NULL) || (nb_threads > 0 && pool->threads == NULL))
+    {
+        fprintf(stderr, "malloc failed\n");
+        free(pool->slots);
+        free(pool->threads);
+        pool->slots = NULL;
+        pool->threads = NULL;
+        return LIKE_ERR_MALLOC;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->not_full, NULL);
+    pthread_cond_init(&pool->refilled, NULL);
+
+    for(size_t i = 0; i < nb_threads; i++)
+    {
+        rc = pthread_create(&pool->threads[i], NULL, pool_refill, pool);
+        if(rc != 0)
+        {
+            fprintf(stderr, "Error with pthread_create\n");
+            pool->nb_threads = i;
+            pool_free(pool);
+            return LIKE_ERR_THREAD;
+        }
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Take an ephemeral from the pool, its slot is zeroized and a refill thread woken up
+ * When the pool is empty the ephemeral is computed on the calling thread instead of waiting
+ * eph : buffer to receive the ephemeral, to zeroize with ephemeral_clear once used
+ * return : LIKE_OK or the error of the on demand computation
+ */
+int pool_get(EphemeralPool * pool, Ephemeral * eph)
+{
+
+    pthread_mutex_lock(&pool->lock);
+    if(pool->count > 0)
+    {
+        pool->count--;
+        *eph = pool->slots[pool->count];
+        ephemeral_clear(&pool->slots[pool->count]);
+        pthread_cond_signal(&pool->not_full);
+        pthread_mutex_unlock(&pool->lock);
+        return LIKE_OK;
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return ephemeral_gen(eph, pool->with_P ? &pool->P : NULL, &pool->Q);
+
+}
+
+/*
+ * return : number of ephemerals ready in the pool
+ */
+size_t pool_count(EphemeralPool * pool)
+{
+
+    size_t count;
+
+    pthread_mutex_lock(&pool->lock);
+    count = pool->count;
+    pthread_mutex_unlock(&pool->lock);
+
+    return count;
+
+}
+
+/*
+ * Wait until the refill threads have filled the pool, returns at once for a pool without thread
+ */
+void pool_wait_full(EphemeralPool * pool)
+{
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->nb_threads > 0 && pool->count < pool->depth)
+    {
+        pthread_cond_wait(&pool->refilled, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+}
+
+/*
+ * Stop the refill threads, zeroize the ephemerals left in the pool and free it
+ */
+void pool_free(EphemeralPool * pool)
+{
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->not_full);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(size_t i = 0; i < pool->nb_threads; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    secure_zero(pool->slots, pool->depth * sizeof(Ephemeral));
+    free(pool->slots);
+    free(pool->threads);
+    pool->slots = NULL;
+    pool->threads = NULL;
+    pool->count = 0;
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->not_full);
+    pthread_cond_destroy(&pool->refilled);
+
+}
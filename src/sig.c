@@ -6,17 +6,22 @@
 #include <openssl/pem.h>
 
 #include "sig.h"
+#include "utils_like.h"
+
+// Signature context kept between the signatures and verifications of the same thread
+static _Thread_local EVP_MD_CTX * sig_md_ctx = NULL;
 
 /*
  * Create an ed25519 public/private key pair and store them in PEM format
  * pub_key_path : path and name of the file to store the public key
  * priv_key_path : path and name of the file to store the private key
+ * return : LIKE_OK, LIKE_ERR_IO or LIKE_ERR_CRYPTO
  */
-void sgen_ed25519(char * pub_key_path, char * priv_key_path)
+int sgen_ed25519(char * pub_key_path, char * priv_key_path)
 {
 
     int rc;
-    int result = 0;
+    int result = LIKE_ERR_CRYPTO;
     FILE * file_pub = NULL;
     FILE * file_priv = NULL;
     EVP_PKEY * pkey = NULL;
@@ -47,6 +52,7 @@ void sgen_ed25519(char * pub_key_path, char * priv_key_path)
     if(file_pub == NULL)
     {
         fprintf(stderr, "Open %s failed\n", pub_key_path);
+        result = LIKE_ERR_IO;
         goto err;
     }
 
@@ -61,6 +67,7 @@ void sgen_ed25519(char * pub_key_path, char * priv_key_path)
     if(file_priv == NULL)
     {
         fprintf(stderr, "Open %s failed\n", priv_key_path);
+        result = LIKE_ERR_IO;
         goto err;
     }
     
@@ -71,57 +78,147 @@ void sgen_ed25519(char * pub_key_path, char * priv_key_path)
         goto err;
     }
 
-    result = 1;
+    result = LIKE_OK;
 
     err:
-        fclose(file_pub);
-        fclose(file_priv);
+        if(file_pub != NULL)
+            fclose(file_pub);
+        if(file_priv != NULL)
+            fclose(file_priv);
         EVP_PKEY_CTX_free(pkey_ctx);
         EVP_PKEY_free(pkey);
-        if(result != 1)
-            exit(EXIT_FAILURE);
+
+    return result;
 
 }
 
 /*
- * Sign a message using ed25519 signature scheme
+ * Load an ed25519 private key from its PEM file, to sign with ssig_ed25519_key until ed25519_key_free
+ * key : key handle to load
  * priv_key_path : path to the file containing the pivate key in PEM format
- * msg : message to sign as bytes array
- * msg_len : length of the array msg
- * sig : address of pointer to store the resulting signature
- * sig_len : length of the signature in bytes
+ * return : LIKE_OK, LIKE_ERR_IO or LIKE_ERR_CRYPTO
  */
-void ssig_ed25519(char * priv_key_path, const unsigned char * msg, size_t msg_len, unsigned char ** sig, size_t * sig_len)
+int ed25519_key_load_priv(Ed25519Key * key, char * priv_key_path)
 {
 
-    int rc;
-    int result = 0;
-    EVP_PKEY * pkey = NULL;
     FILE * file_priv = NULL;
-    EVP_MD_CTX  * md_ctx = NULL;
+
+    key->pkey = NULL;
+    key->is_private = 1;
 
     file_priv = fopen(priv_key_path, "r");
     if(file_priv == NULL)
     {
         fprintf(stderr, "Open %s failed\n", priv_key_path);
-        goto err;
+        return LIKE_ERR_IO;
     }
-   
-    pkey = PEM_read_PrivateKey(file_priv, NULL, NULL, NULL);
-    if(pkey == NULL)
+
+    key->pkey = PEM_read_PrivateKey(file_priv, NULL, NULL, NULL);
+    fclose(file_priv);
+    if(key->pkey == NULL)
     {
         fprintf(stderr, "PEM_read_PrivateKey failed, error 0x%lx\n", ERR_get_error());
-        goto err;
+        return LIKE_ERR_CRYPTO;
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Load an ed25519 public key from its PEM file, to verify with sver_ed25519_key until ed25519_key_free
+ * key : key handle to load
+ * pub_key_path : path to the file containing the public key in PEM format
+ * return : LIKE_OK, LIKE_ERR_IO or LIKE_ERR_CRYPTO
+ */
+int ed25519_key_load_pub(Ed25519Key * key, char * pub_key_path)
+{
+
+    FILE * file_pub = NULL;
+
+    key->pkey = NULL;
+    key->is_private = 0;
+
+    file_pub = fopen(pub_key_path, "r");
+    if(file_pub == NULL)
+    {
+        fprintf(stderr, "Open %s failed\n", pub_key_path);
+        return LIKE_ERR_IO;
     }
 
-    md_ctx = EVP_MD_CTX_create();
-    if(md_ctx == NULL) 
+    key->pkey = PEM_read_PUBKEY(file_pub, NULL, NULL, NULL);
+    fclose(file_pub);
+    if(key->pkey == NULL)
     {
-        printf("EVP_MD_CTX_create failed, error 0x%lx\n", ERR_get_error());
-        goto err;
+        fprintf(stderr, "PEM_read_PUBKEY failed, error 0x%lx\n", ERR_get_error());
+        return LIKE_ERR_CRYPTO;
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Release a key loaded by ed25519_key_load_priv or ed25519_key_load_pub, no thread must be using it
+ */
+void ed25519_key_free(Ed25519Key * key)
+{
+
+    EVP_PKEY_free(key->pkey);
+    key->pkey = NULL;
+
+}
+
+/*
+ * Get the signature context of the thread, created on its first use
+ * return : the context or NULL if it can not be created
+ */
+static EVP_MD_CTX * sig_get_md_ctx(void)
+{
+
+    if(sig_md_ctx == NULL)
+    {
+        sig_md_ctx = EVP_MD_CTX_new();
+        if(sig_md_ctx == NULL)
+        {
+            fprintf(stderr, "EVP_MD_CTX_new failed, error 0x%lx\n", ERR_get_error());
+        }
     }
 
-    rc = EVP_DigestSignInit(md_ctx, NULL, NULL, NULL, pkey);
+    return sig_md_ctx;
+
+}
+
+/*
+ * Sign a message using ed25519 signature scheme with a loaded private key
+ * The key is only read, threads can sign with the same key at once, each one with its own context
+ * key : private key loaded by ed25519_key_load_priv
+ * msg : message to sign as bytes array
+ * msg_len : length of the array msg
+ * sig : address of pointer to store the resulting signature
+ * sig_len : length of the signature in bytes
+ * return : LIKE_OK or LIKE_ERR_CRYPTO
+ */
+int ssig_ed25519_key(Ed25519Key * key, const unsigned char * msg, size_t msg_len, unsigned char ** sig, size_t * sig_len)
+{
+
+    int rc;
+    int result = LIKE_ERR_CRYPTO;
+    EVP_MD_CTX * md_ctx = NULL;
+
+    if(key->pkey == NULL || key->is_private == 0)
+    {
+        fprintf(stderr, "ssig_ed25519_key needs a loaded private key\n");
+        return LIKE_ERR_CRYPTO;
+    }
+
+    md_ctx = sig_get_md_ctx();
+    if(md_ctx == NULL)
+    {
+        return LIKE_ERR_CRYPTO;
+    }
+
+    rc = EVP_DigestSignInit(md_ctx, NULL, NULL, NULL, key->pkey);
     if(rc != 1)
     {
         printf("EVP_DigestSignInit failed, error 0x%lx\n", ERR_get_error());
@@ -135,77 +232,122 @@ void ssig_ed25519(char * priv_key_path, const unsigned char * msg, size_t msg_le
         goto err;
     }
 
-    result = 1;
+    result = LIKE_OK;
 
     err:
-        EVP_MD_CTX_free(md_ctx);
-        EVP_PKEY_free(pkey);
-        fclose(file_priv);
-        if(result != 1)
-            exit(EXIT_FAILURE);
+        EVP_MD_CTX_reset(md_ctx);
+
+    return result;
 
 }
 
 /*
- * Verify an ed25519 signature
- * pub_key_path : path to the file containing the public key in PEM format
+ * Verify an ed25519 signature with a loaded public key
+ * The key is only read, threads can verify with the same key at once, each one with its own context
+ * key : public key loaded by ed25519_key_load_pub
  * msg : the message as bytes array
  * msg_len : length of the array msg
  * sig : the signature of msg
  * sig_len : length of the signature in bytes
- * return : 1 if verification succed
+ * return : LIKE_OK if verification succed, LIKE_ERR_VERIFY for a wrong signature or LIKE_ERR_CRYPTO
  */
-void sver_ed25519(char * pub_key_path, const unsigned char * msg, size_t msg_len, unsigned char * sig, size_t sig_len)
+int sver_ed25519_key(Ed25519Key * key, const unsigned char * msg, size_t msg_len, unsigned char * sig, size_t sig_len)
 {
 
     int rc;
-    int result = 0;
-    FILE * file_pub = NULL;
-    EVP_PKEY * pkey = NULL;
-    EVP_MD_CTX  * md_ctx = NULL;
-
-    file_pub = fopen(pub_key_path, "r");
-    if(file_pub == NULL)
-    {
-        fprintf(stderr, "Open %s failed\n", pub_key_path);
-        goto err;
-    }
+    int result = LIKE_ERR_CRYPTO;
+    EVP_MD_CTX * md_ctx = NULL;
 
-    pkey = PEM_read_PUBKEY(file_pub, NULL, NULL, NULL);
-    if(pkey == NULL)
+    if(key->pkey == NULL)
     {
-        fprintf(stderr, "PEM_read_PUBKEY failed, error 0x%lx\n", ERR_get_error());
-        goto err;
+        fprintf(stderr, "sver_ed25519_key needs a loaded key\n");
+        return LIKE_ERR_CRYPTO;
     }
 
-    md_ctx = EVP_MD_CTX_create();
-    if(md_ctx == NULL) 
+    md_ctx = sig_get_md_ctx();
+    if(md_ctx == NULL)
     {
-        printf("EVP_MD_CTX_create failed, error 0x%lx\n", ERR_get_error());
-        goto err;
+        return LIKE_ERR_CRYPTO;
     }
 
-    rc = EVP_DigestVerifyInit(md_ctx, NULL, NULL, NULL, pkey);
+    rc = EVP_DigestVerifyInit(md_ctx, NULL, NULL, NULL, key->pkey);
     if(rc != 1)
     {
         printf("EVP_DigestVerifyInit failed, error 0x%lx\n", ERR_get_error());
         goto err;
     }
 
+    // 0 is a wrong signature, it is not printed so that a flood of forged messages does not flood the output
     rc = EVP_DigestVerify(md_ctx, sig, sig_len, msg, msg_len);
     if(rc != 1)
     {
-        printf("EVP_DigestVerify failed, error 0x%lx\n", ERR_get_error());
+        if(rc < 0)
+        {
+            printf("EVP_DigestVerify failed, error 0x%lx\n", ERR_get_error());
+        }
+        result = LIKE_ERR_VERIFY;
         goto err;
-    }  
+    }
 
-    result = 1;
+    result = LIKE_OK;
 
     err:
-        EVP_MD_CTX_free(md_ctx);
-        EVP_PKEY_free(pkey);
-        fclose(file_pub);
-        if(result != 1)
-            exit(EXIT_FAILURE);
+        EVP_MD_CTX_reset(md_ctx);
+
+    return result;
+
+}
+
+/*
+ * Sign a message using ed25519 signature scheme, the private key is read from its file for this signature only
+ * Prefer ed25519_key_load_priv and ssig_ed25519_key to sign more than once with the same key
+ * priv_key_path : path to the file containing the pivate key in PEM format
+ * msg : message to sign as bytes array
+ * msg_len : length of the array msg
+ * sig : address of pointer to store the resulting signature
+ * sig_len : length of the signature in bytes
+ * return : LIKE_OK, LIKE_ERR_IO or LIKE_ERR_CRYPTO
+ */
+int ssig_ed25519(char * priv_key_path, const unsigned char * msg, size_t msg_len, unsigned char ** sig, size_t * sig_len)
+{
+
+    int rc;
+    Ed25519Key key;
+
+    rc = ed25519_key_load_priv(&key, priv_key_path);
+    if(rc == LIKE_OK)
+    {
+        rc = ssig_ed25519_key(&key, msg, msg_len, sig, sig_len);
+    }
+    ed25519_key_free(&key);
+
+    return rc;
+
+}
+
+/*
+ * Verify an ed25519 signature, the public key is read from its file for this verification only
+ * Prefer ed25519_key_load_pub and sver_ed25519_key to verify more than once with the same key
+ * pub_key_path : path to the file containing the public key in PEM format
+ * msg : the message as bytes array
+ * msg_len : length of the array msg
+ * sig : the signature of msg
+ * sig_len : length of the signature in bytes
+ * return : LIKE_OK if verification succed, LIKE_ERR_VERIFY for a wrong signature, LIKE_ERR_IO or LIKE_ERR_CRYPTO
+ */
+int sver_ed25519(char * pub_key_path, const unsigned char * msg, size_t msg_len, unsigned char * sig, size_t sig_len)
+{
+
+    int rc;
+    Ed25519Key key;
+
+    rc = ed25519_key_load_pub(&key, pub_key_path);
+    if(rc == LIKE_OK)
+    {
+        rc = sver_ed25519_key(&key, msg, msg_len, sig, sig_len);
+    }
+    ed25519_key_free(&key);
+
+    return rc;
 
 }
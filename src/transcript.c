@@ -0,0 +1,324 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <openssl/sha.h>
+#include <openssl/evp.h>
+#include <openssl/err.h>
+
+#include "bn512.h"
+#include "transcript.h"
+#include "normalize.h"
+#include "utils_like.h"
+
+// Digest context kept between transcripts of the same thread
+static _Thread_local EVP_MD_CTX * md_ctx_cache = NULL;
+
+/*
+ * Record the first failure of a transcript and release its context
+ */
+static void transcript_fail(Transcript * t, int status)
+{
+
+    if(t->status == LIKE_OK)
+    {
+        t->status = status;
+    }
+    EVP_MD_CTX_free(t->md_ctx);
+    t->md_ctx = NULL;
+
+}
+
+/*
+ * Start a Fiat-Shamir transcript, a running sha256 over the absorbed elements
+ * Errors are not returned here but by transcript_get_hash, the absorbs in between do nothing
+ * t : transcript to initialize
+ */
+void transcript_init(Transcript * t)
+{
+
+    int rc;
+
+    t->status = LIKE_OK;
+
+    // Reuse the context of the thread if no other transcript holds it
+    t->md_ctx = md_ctx_cache;
+    md_ctx_cache = NULL;
+    if(t->md_ctx == NULL)
+    {
+        t->md_ctx = EVP_MD_CTX_new();
+        if(t->md_ctx == NULL)
+        {
+            fprintf(stderr, "EVP_MD_CTX_new failed, error 0x%lx\n", ERR_get_error());
+            t->status = LIKE_ERR_CRYPTO;
+            return;
+        }
+    }
+
+    rc = EVP_DigestInit_ex(t->md_ctx, EVP_sha256(), NULL);
+    if(rc != 1)
+    {
+        fprintf(stderr, "EVP_DigestInit_ex failed, error 0x%lx\n", ERR_get_error());
+        transcript_fail(t, LIKE_ERR_CRYPTO);
+    }
+
+}
+
+/*
+ * Absorb a bytes array
+ * t : transcript
+ * data : bytes array
+ * data_len : length of data
+ */
+void transcript_absorb_bytes(Transcript * t, const unsigned char * data, size_t data_len)
+{
+
+    int rc;
+
+    if(t->status != LIKE_OK)
+    {
+        return;
+    }
+
+    rc = EVP_DigestUpdate(t->md_ctx, data, data_len);
+    if(rc != 1)
+    {
+        fprintf(stderr, "EVP_DigestUpdate failed, error 0x%lx\n", ERR_get_error());
+        transcript_fail(t, LIKE_ERR_CRYPTO);
+    }
+
+}
+
+/*
+ * Absorb the serialization of an Fr element
+ */
+void transcript_absorb_Fr(Transcript * t, mclBnFr * x)
+{
+
+    unsigned char bytes[FR_MAX_LENGTH];
+    size_t len = mclBnFr_serialize(bytes, sizeof(bytes), x);
+    if(len == 0)
+    {
+        transcript_fail(t, handle_mcl_error(len, "Error with mclBnFr_serialize"));
+        return;
+    }
+    transcript_absorb_bytes(t, bytes, len);
+
+}
+
+/*
+ * Absorb the serialization of a G1 point
+ */
+void transcript_absorb_G1(Transcript * t, mclBnG1 * x)
+{
+
+    unsigned char bytes[G1_MAX_LENGTH];
+    size_t len = mclBnG1_serialize(bytes, sizeof(bytes), x);
+    if(len == 0)
+    {
+        transcript_fail(t, handle_mcl_error(len, "Error with mclBnG1_serialize"));
+        return;
+    }
+    transcript_absorb_bytes(t, bytes, len);
+
+}
+
+/*
+ * Absorb the serialization of a G2 point
+ */
+void transcript_absorb_G2(Transcript * t, mclBnG2 * x)
+{
+
+    unsigned char bytes[G2_MAX_LENGTH];
+    size_t len = mclBnG2_serialize(bytes, sizeof(bytes), x);
+    if(len == 0)
+    {
+        transcript_fail(t, handle_mcl_error(len, "Error with mclBnG2_serialize"));
+        return;
+    }
+    transcript_absorb_bytes(t, bytes, len);
+
+}
+
+/*
+ * Absorb the serializations of n G1 points, normalized together first so that they cost one inversion and not n
+ * x : array of n pointers to the points
+ */
+void transcript_absorb_G1_vec(Transcript * t, mclBnG1 ** x, size_t n)
+{
+
+    mclBnG1 stack_affine[LIKE_NORMALIZE_STACK];
+    mclBnG1 * affine = stack_affine;
+
+    if(n > LIKE_NORMALIZE_STACK)
+    {
+        affine = (mclBnG1 *) malloc(n * sizeof(mclBnG1));
+    }
+
+    // Without the memory, each serialization normalizes its own copy
+    if(affine == NULL)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            transcript_absorb_G1(t, x[i]);
+        }
+        return;
+    }
+
+    G1_normalize_copy(affine, x, n);
+    for(size_t i = 0; i < n; i++)
+    {
+        transcript_absorb_G1(t, &affine[i]);
+    }
+
+    if(affine != stack_affine)
+        free(affine);
+
+}
+
+/*
+ * Same as transcript_absorb_G1_vec for G2 points
+ */
+void transcript_absorb_G2_vec(Transcript * t, mclBnG2 ** x, size_t n)
+{
+
+    mclBnG2 stack_affine[LIKE_NORMALIZE_STACK];
+    mclBnG2 * affine = stack_affine;
+
+    if(n > LIKE_NORMALIZE_STACK)
+    {
+        affine = (mclBnG2 *) malloc(n * sizeof(mclBnG2));
+    }
+
+    // Without the memory, each serialization normalizes its own copy
+    if(affine == NULL)
+    {
+        for(size_t i = 0; i < n; i++)
+        {
+            transcript_absorb_G2(t, x[i]);
+        }
+        return;
+    }
+
+    G2_normalize_copy(affine, x, n);
+    for(size_t i = 0; i < n; i++)
+    {
+        transcript_absorb_G2(t, &affine[i]);
+    }
+
+    if(affine != stack_affine)
+        free(affine);
+
+}
+
+/*
+ * Absorb the serialization of a GT element
+ */
+void transcript_absorb_GT(Transcript * t, mclBnGT * x)
+{
+
+    unsigned char bytes[GT_MAX_LENGTH];
+    size_t len = mclBnGT_serialize(bytes, sizeof(bytes), x);
+    if(len == 0)
+    {
+        transcript_fail(t, handle_mcl_error(len, "Error with mclBnGT_serialize"));
+        return;
+    }
+    transcript_absorb_bytes(t, bytes, len);
+
+}
+
+/*
+ * Absorb the base 16 string representation of a G1 point
+ */
+void transcript_absorb_G1_str(Transcript * t, mclBnG1 * x)
+{
+
+    char str[STR_MAX_LENGTH];
+    size_t len = mclBnG1_getStr(str, sizeof(str), x, 16);
+    if(len == 0)
+    {
+        transcript_fail(t, handle_mcl_error(len, "Error with mclBnG1_getStr"));
+        return;
+    }
+    transcript_absorb_bytes(t, (unsigned char *)str, len);
+
+}
+
+/*
+ * Absorb the base 16 string representation of a GT element
+ */
+void transcript_absorb_GT_str(Transcript * t, mclBnGT * x)
+{
+
+    char str[STR_MAX_LENGTH];
+    size_t len = mclBnGT_getStr(str, sizeof(str), x, 16);
+    if(len == 0)
+    {
+        transcript_fail(t, handle_mcl_error(len, "Error with mclBnGT_getStr"));
+        return;
+    }
+    transcript_absorb_bytes(t, (unsigned char *)str, len);
+
+}
+
+/*
+ * Finalize the transcript, it can not absorb anymore after this call
+ * t : transcript
+ * hash : buffer of SHA256_DIGEST_LENGTH bytes to receive the hash
+ * return : LIKE_OK or the first error met since transcript_init
+ */
+int transcript_get_hash(Transcript * t, unsigned char * hash)
+{
+
+    int rc;
+    unsigned int hash_len = SHA256_DIGEST_LENGTH;
+
+    if(t->status != LIKE_OK)
+    {
+        return t->status;
+    }
+
+    rc = EVP_DigestFinal_ex(t->md_ctx, hash, &hash_len);
+    if(rc != 1)
+    {
+        fprintf(stderr, "EVP_DigestFinal_ex failed, error 0x%lx\n", ERR_get_error());
+        transcript_fail(t, LIKE_ERR_CRYPTO);
+        return t->status;
+    }
+
+    // Give the context back to the thread
+    if(md_ctx_cache == NULL)
+    {
+        md_ctx_cache = t->md_ctx;
+    }
+    else
+    {
+        EVP_MD_CTX_free(t->md_ctx);
+    }
+    t->md_ctx = NULL;
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Finalize the transcript and get the challenge e <-- H(transcript) mod r
+ * t : transcript
+ * e : buffer of Fr object to receive the challenge
+ * return : LIKE_OK or an error status
+ */
+int transcript_get_challenge(Transcript * t, mclBnFr * e)
+{
+
+    int status;
+    unsigned char hash[SHA256_DIGEST_LENGTH];
+
+    status = transcript_get_hash(t, hash);
+    if(status != LIKE_OK)
+    {
+        return status;
+    }
+
+    return hash_to_Fr(e, hash);
+
+}
@@ -6,21 +6,25 @@
 #include <openssl/sha.h>
 #include <openssl/evp.h>
 #include <openssl/err.h>
+#include <openssl/rand.h>
 
+#include "bn512.h"
 #include "utils_like.h"
 
 /*
- * Print mcl error and exit 
+ * Print mcl error
  * rc : return code from mcl call
  * msg : error message
+ * return : LIKE_ERR_MCL, to be returned by the caller
  */
-void handle_mcl_error(int rc, char * msg)
+int handle_mcl_error(int rc, char * msg)
 {
 
     //fprintf(stderr, msg);
     fprintf(stderr, "error msg : %s\n", msg);
     fprintf(stderr, "error code : %d\n", rc);
-    exit(EXIT_FAILURE);
+
+    return LIKE_ERR_MCL;
 
 }
 
@@ -28,12 +32,16 @@ void handle_mcl_error(int rc, char * msg)
  * Convert bytes array to a hexadecimal string reprersentation (without 0x)
  * data_bytes : Array of bytes 
  * data_bytes_len : Length of the array
- * Return : pointer to the resulting hexadecimal string, must be free()
+ * Return : pointer to the resulting hexadecimal string, must be free(), NULL if the allocation failed
  */
 char *  bytes_to_hexstring(unsigned char * data_bytes, size_t data_bytes_len)
 {
 
     char * data_hexstring = (char * ) malloc(sizeof(char) * ((data_bytes_len * 2) + 1));
+    if(data_hexstring == NULL)
+    {
+        return NULL;
+    }
    
     for(int i = 0; i < (int)data_bytes_len; i++)
     {
@@ -45,11 +53,104 @@ char *  bytes_to_hexstring(unsigned char * data_bytes, size_t data_bytes_len)
 
 }
 
+/*
+ * Map a sha256 hash to an Fr element through its hexadecimal string representation
+ * Legacy path, kept to compare against hash_to_Fr and for builds with LIKE_HEX_CHALLENGE
+ * e : buffer of Fr object to receive the result
+ * hash : hash as bytes array of SHA256_DIGEST_LENGTH bytes
+ * return : LIKE_OK or an error status
+ */
+int hash_to_Fr_hexstring(mclBnFr * e, unsigned char * hash)
+{
+
+    int rc;
+
+    char * e_str = bytes_to_hexstring(hash, SHA256_DIGEST_LENGTH);
+    if(e_str == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return LIKE_ERR_MALLOC;
+    }
+    rc = mclBnFr_setStr(e, e_str, strnlen(e_str, (SHA256_DIGEST_LENGTH * 2) + 1), 16);
+    free(e_str);
+    if(rc != 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_setStr");
+    }
+
+    return LIKE_OK;
+
+}
+
+/*
+ * Map a sha256 hash to an Fr element
+ * The hash is read as a big-endian integer, as the hexadecimal path does, so both paths give the same element (256 bits < r)
+ * Compile with -DLIKE_HEX_CHALLENGE to force the legacy hexadecimal path
+ * e : buffer of Fr object to receive the result
+ * hash : hash as bytes array of SHA256_DIGEST_LENGTH bytes
+ * return : LIKE_OK or an error status
+ */
+int hash_to_Fr(mclBnFr * e, unsigned char * hash)
+{
+
+#ifdef LIKE_HEX_CHALLENGE
+    return hash_to_Fr_hexstring(e, hash);
+#else
+    int rc;
+    unsigned char hash_le[SHA256_DIGEST_LENGTH];
+
+    // mcl reads little-endian bytes
+    for(int i = 0; i < SHA256_DIGEST_LENGTH; i++)
+    {
+        hash_le[i] = hash[SHA256_DIGEST_LENGTH - 1 - i];
+    }
+
+    rc = mclBnFr_setLittleEndianMod(e, hash_le, SHA256_DIGEST_LENGTH);
+    if(rc != 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_setLittleEndianMod");
+    }
+
+    return LIKE_OK;
+#endif
+
+}
+
+/*
+ * Draw a random 128 bits integer in Fr, used as weight in batch verifications
+ * The top bit is set so the weight is never zero
+ * w : buffer of Fr object to receive the weight
+ * return : LIKE_OK or an error status
+ */
+int rand_Fr_128(mclBnFr * w)
+{
+
+    int rc;
+    unsigned char w_bytes[16];
+
+    rc = RAND_bytes(w_bytes, sizeof(w_bytes));
+    if(rc != 1)
+    {
+        fprintf(stderr, "RAND_bytes failed, error 0x%lx\n", ERR_get_error());
+        return LIKE_ERR_CRYPTO;
+    }
+    w_bytes[sizeof(w_bytes) - 1] |= 0x80;
+
+    rc = mclBnFr_setLittleEndian(w, w_bytes, sizeof(w_bytes));
+    if(rc != 0)
+    {
+        return handle_mcl_error(rc, "Error with mclBnFr_setLittleEndian");
+    }
+
+    return LIKE_OK;
+
+}
+
 /*
  * Compute sha256
  * data : data to hash as a bytes array
  * data_len : length of data array
- * return : pointer to the hash as bytes array, must be free()
+ * return : pointer to the hash as bytes array, must be free(), NULL on error
  */
 unsigned char * sha256(unsigned char * data, size_t data_len)
 {
@@ -64,7 +165,7 @@ unsigned char * sha256(unsigned char * data, size_t data_len)
     {
         fprintf(stderr, "EVP_MD_CTX_new failed, error 0x%lx\n", ERR_get_error());
         EVP_MD_CTX_free(md_ctx);
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
     rc = EVP_DigestInit_ex(md_ctx, EVP_sha256(), NULL);
@@ -72,7 +173,7 @@ unsigned char * sha256(unsigned char * data, size_t data_len)
     {
         fprintf(stderr, "EVP_DigestInit_ex failed, error 0x%lx\n", ERR_get_error());
         EVP_MD_CTX_free(md_ctx);
-        exit(EXIT_FAILURE);
+        return NULL;
     }
     
     rc = EVP_DigestUpdate(md_ctx, data, data_len);
@@ -80,7 +181,7 @@ unsigned char * sha256(unsigned char * data, size_t data_len)
     {
         fprintf(stderr, "EVP_DigestUpdate failed, error 0x%lx\n", ERR_get_error());
         EVP_MD_CTX_free(md_ctx);
-        exit(EXIT_FAILURE);
+        return NULL;
     }
     
     hash = (unsigned char *)OPENSSL_malloc(EVP_MD_size(EVP_sha256()));
@@ -88,7 +189,7 @@ unsigned char * sha256(unsigned char * data, size_t data_len)
     {
         fprintf(stderr, "OPENSSL_malloc failed, error 0x%lx\n", ERR_get_error());
         EVP_MD_CTX_free(md_ctx);
-        exit(EXIT_FAILURE);
+        return NULL;
     }
 
     rc = EVP_DigestFinal_ex(md_ctx, hash, &hash_len);
@@ -96,7 +197,8 @@ unsigned char * sha256(unsigned char * data, size_t data_len)
     {
         fprintf(stderr, "EVP_DigestFinal_ex failed, error 0x%lx\n", ERR_get_error());
         EVP_MD_CTX_free(md_ctx);
-        exit(EXIT_FAILURE);
+        OPENSSL_free(hash);
+        return NULL;
     }
 
     EVP_MD_CTX_free(md_ctx);
@@ -1,9 +1,11 @@
 #include <time.h>
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <unistd.h>
 
 #include <uuid/uuid.h>
 
@@ -15,6 +17,10 @@
 #include "pok.h"
 #include "like.h"
 #include "bn512.h"
+#include "pool.h"
+#include "pairing.h"
+#include "fixed_base.h"
+#include "normalize.h"
 #include "utils_like.h"
 
 double print_trials_res(double * trials_res, int nb_trials) 
@@ -61,6 +67,99 @@ void mesure_pairing(int nb_trials)
 
 }
 
+void mesure_pairing_product(int nb_trials)
+{
+
+    mclBnG1 P, xP;
+    mclBnG2 Q, xQ;
+    mclBnGT e1, e2, e_prod, e_ref;
+    mclBnFr x;
+    mclBnG1 pairing_P[2];
+    mclBnG2 pairing_Q[2];
+    int check_ok = 1;
+
+    mclBn_init(MCL_BN462, MCLBN_COMPILED_TIME_VAR);
+
+    mclBnFr_setByCSPRNG(&x);
+    mclBnG1_hashAndMapTo(&P, "abc", 3);
+    mclBnG2_hashAndMapTo(&Q, "def", 3);
+    mclBnG1_mul(&xP, &P, &x);
+    mclBnG2_mul(&xQ, &Q, &x);
+
+    // Product of two pairings against two separate pairings
+    pairing_P[0] = xP;
+    pairing_P[1] = P;
+    pairing_Q[0] = Q;
+    pairing_Q[1] = xQ;
+    pairing_product(&e_prod, pairing_P, pairing_Q, 2);
+    mclBn_pairing(&e1, &xP, &Q);
+    mclBn_pairing(&e2, &P, &xQ);
+    mclBnGT_mul(&e_ref, &e1, &e2);
+    check_ok &= mclBnGT_isEqual(&e_prod, &e_ref);
+
+    // verify_mx check e(xP, Q) * e(-P, xQ) == 1, valid then with a wrong xQ
+    mclBnG1_neg(&pairing_P[1], &P);
+    check_ok &= (mclBnGT_isEqual(&e1, &e2) == pairing_product_is_one(pairing_P, pairing_Q, 2));
+    pairing_Q[1] = Q;
+    check_ok &= (pairing_product_is_one(pairing_P, pairing_Q, 2) == 0);
+    pairing_Q[1] = xQ;
+
+    printf("pairing_product check against mclBn_pairing : %s\n\n", check_ok ? "OK" : "FAILED");
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    printf("e(xP, Q) == e(P, xQ) (two pairings) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        mclBn_pairing(&e1, &xP, &Q);
+        mclBn_pairing(&e2, &P, &xQ);
+        mclBnGT_isEqual(&e1, &e2);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    printf("e(xP, Q) * e(-P, xQ) == 1 (pairing_product_is_one) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        pairing_product_is_one(pairing_P, pairing_Q, 2);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    // Same checks with the lines of Q precomputed as setup() does
+    pairing_init_generator(&Q);
+    pairing_P[1] = P;
+    pairing_product(&e_prod, pairing_P, pairing_Q, 2);
+    check_ok = mclBnGT_isEqual(&e_prod, &e_ref);
+    mclBnG1_neg(&pairing_P[1], &P);
+    check_ok &= pairing_product_is_one(pairing_P, pairing_Q, 2);
+    pairing_Q[1] = Q;
+    check_ok &= (pairing_product_is_one(pairing_P, pairing_Q, 2) == 0);
+    pairing_Q[1] = xQ;
+
+    printf("pairing_product with precomputed Q lines (%zu bytes) check : %s\n\n", g2_lines_size(), check_ok ? "OK" : "FAILED");
+
+    printf("e(xP, Q) * e(-P, xQ) == 1 (precomputed Q lines) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        pairing_product_is_one(pairing_P, pairing_Q, 2);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+}
+
 void mesure_arithmetic_EC(int nb_trials)
 {
 
@@ -120,12 +219,69 @@ void mesure_arithmetic_EC(int nb_trials)
 
 }
 
+void mesure_fixed_base(int nb_trials)
+{
+
+    int windows[] = {2, 4, 6, 8};
+    mclBnG1 P, xP;
+    mclBnG2 Q, xQ;
+    mclBnFr x;
+    FB_G1 fb_G1;
+    FB_G2 fb_G2;
+
+    mclBnFr_setByCSPRNG(&x);
+    mclBnG1_hashAndMapTo(&P, "abc", 3);
+    mclBnG2_hashAndMapTo(&Q, "def", 3);
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    for(size_t w = 0; w < sizeof(windows) / sizeof(int); w++)
+    {
+
+        begin = clock();
+        fb_G1_init(&fb_G1, &P, windows[w]);
+        fb_G2_init(&fb_G2, &Q, windows[w]);
+        end = clock();
+        printf("Fixed-base tables with %d bits window : G1 %zu KB, G2 %zu KB, built in %f\n\n", windows[w], fb_G1_size(&fb_G1) / 1024, fb_G2_size(&fb_G2) / 1024, ((double)(end - begin) / CLOCKS_PER_SEC) * 1000);
+
+        printf("Fixed-base scalar mult in G1 (%d bits window) : \n", windows[w]);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            fb_G1_mul(&xP, &fb_G1, &x);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        printf("Fixed-base scalar mult in G2 (%d bits window) : \n", windows[w]);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            fb_G2_mul(&xQ, &fb_G2, &x);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        fb_G1_free(&fb_G1);
+        fb_G2_free(&fb_G2);
+
+    }
+
+}
+
 void mesure_edd25519(int nb_trials)
 {
     struct stat st = {0};
     size_t sig_len = ED25519_SIG_LENGTH;
     unsigned char * sig = (unsigned char *) malloc(sig_len * sizeof(unsigned char));;
     unsigned char msg[] = "Test sig";
+    Ed25519Key priv_key = {NULL, 1};
+    Ed25519Key pub_key = {NULL, 0};
+    int ok = 1;
 
     if (stat("./keys", &st) == -1) {
         mkdir("./keys", 0700);
@@ -137,7 +293,7 @@ void mesure_edd25519(int nb_trials)
     clock_t begin;
     clock_t end;
 
-    printf("sig ed25519 : \n");
+    printf("sig ed25519, key read from its file : \n");
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
@@ -148,7 +304,7 @@ void mesure_edd25519(int nb_trials)
 
     print_trials_res(trials_res, nb_trials);
 
-    printf("verif ed25519 : \n");
+    printf("verif ed25519, key read from its file : \n");
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
@@ -159,7 +315,113 @@ void mesure_edd25519(int nb_trials)
 
     print_trials_res(trials_res, nb_trials);
 
-    free(sig);
+    printf("load ed25519 private key : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        ed25519_key_load_priv(&priv_key, "keys/priv.pem");
+        end = clock();
+        ed25519_key_free(&priv_key);
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    printf("load ed25519 public key : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        ed25519_key_load_pub(&pub_key, "keys/pub.pem");
+        end = clock();
+        ed25519_key_free(&pub_key);
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    if(ed25519_key_load_priv(&priv_key, "keys/priv.pem") != LIKE_OK || ed25519_key_load_pub(&pub_key, "keys/pub.pem") != LIKE_OK)
+    {
+        printf("ed25519 keys could not be loaded\n\n");
+        goto err;
+    }
+
+    printf("sig ed25519, loaded key : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        ssig_ed25519_key(&priv_key, msg, sizeof(msg), &sig, &sig_len);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    printf("verif ed25519, loaded key : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        ok &= (sver_ed25519_key(&pub_key, msg, sizeof(msg), sig, sig_len) == LIKE_OK);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+    if(ok == 0)
+    {
+        printf("sver_ed25519_key : wrong result\n\n");
+    }
+
+    err:
+        ed25519_key_free(&priv_key);
+        ed25519_key_free(&pub_key);
+        free(sig);
+
+}
+
+void mesure_challenge(int nb_trials)
+{
+
+    unsigned char msg[] = "test";
+    unsigned char * hash = sha256(msg, sizeof(msg));
+    mclBnFr e_hex, e_bin;
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    if(hash == NULL)
+    {
+        printf("sha256 failed\n");
+        return;
+    }
+
+    printf("challenge from hash (hexstring) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        hash_to_Fr_hexstring(&e_hex, hash);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_hex = print_trials_res(trials_res, nb_trials);
+
+    printf("challenge from hash (binary) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        hash_to_Fr(&e_bin, hash);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_bin = print_trials_res(trials_res, nb_trials);
+
+    if(mclBnFr_isEqual(&e_hex, &e_bin) != 1)
+    {
+        printf("Challenges not equal\n");
+    }
+    printf("Saving per proof (1 challenge) : %f\n\n", time_hex - time_bin);
+
+    free(hash);
 
 }
 
@@ -171,6 +433,7 @@ void mesure_sok(int nb_trials)
     char msg[] = "test";
     mclBnFr x, d;
     mclBnG2 Q, xQ, Rho;
+    unsigned char e[CHALLENGE_LENGTH];
 
     mclBnFr_setByCSPRNG(&x);
     mclBnG2_setStr(&Q, G2_basePoint_hexstr, strlen(G2_basePoint_hexstr), 16);
@@ -202,6 +465,30 @@ void mesure_sok(int nb_trials)
 
     print_trials_res(trials_res, nb_trials);
 
+    printf("sok_G2_compact : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        sok_G2_compact(&Q, &x, &xQ, (unsigned char *)msg, strlen(msg), e, &d);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    printf("sokver_G2_compact : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        sokver_G2_compact(&Q, &xQ, e, &d, (unsigned char *)msg, strlen(msg));
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    printf("sok_G2 proof size : %zu bytes, compact : %zu bytes\n\n", (size_t)(mclBn_getG1ByteSize() * 2 + mclBn_getFrByteSize()), (size_t)(CHALLENGE_LENGTH + mclBn_getFrByteSize()));
+
 }
 
 void mesure_nipok(int nb_trials)
@@ -211,6 +498,7 @@ void mesure_nipok(int nb_trials)
 
     mclBnFr x, d;
     mclBnG1 P, xP, Rho;
+    unsigned char e[CHALLENGE_LENGTH];
 
     mclBnFr_setByCSPRNG(&x);
     mclBnG1_setStr(&P, G1_basePoint_hexstr, strlen(G1_basePoint_hexstr), 16);
@@ -243,6 +531,30 @@ void mesure_nipok(int nb_trials)
 
     print_trials_res(trials_res, nb_trials);
 
+    printf("nipok_G1_compact : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        nipok_G1_compact(&P, &x, &xP, e, &d);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    printf("nipokver_G1_compact : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        nipokver_G1_compact(&P, &xP, e, &d);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    print_trials_res(trials_res, nb_trials);
+
+    printf("nipok_G1 proof size : %zu bytes, compact : %zu bytes\n\n", (size_t)(mclBn_getG1ByteSize() + mclBn_getFrByteSize()), (size_t)(CHALLENGE_LENGTH + mclBn_getFrByteSize()));
+
 }
 
 void mesure_eqnipok(int nb_trials)
@@ -290,7 +602,220 @@ void mesure_eqnipok(int nb_trials)
 
 }
 
-double mesure_ake_a_get_mx(mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, int nb_trials)
+void mesure_eqnipok_GT(int nb_trials)
+{
+
+    const char * G1_basePoint_hexstr = "1 21a6d67ef250191fadba34a0a30160b9ac9264b6f95f63b3edbec3cf4b2e689db1bbb4e69a416a0b1e79239c0372e5cd70113c98d91f36b6980d 0118ea0460f7f7abb82b33676a7432a490eeda842cccfa7d788c659650426e6af77df11b8ae40eb80f475432c66600622ecaa8a5734d36fb03de";
+
+    int versions[2] = {EQ_NIPOK_GT_STR, EQ_NIPOK_GT_BIN};
+    char * versions_name[2] = {"hexstring", "binary"};
+    mclBnFr x, d;
+    mclBnG1 P, xP, Rho;
+    mclBnG2 Q;
+    mclBnGT pairing_res, x_pairing_res, sigma;
+
+    mclBnFr_setByCSPRNG(&x);
+    mclBnG1_setStr(&P, G1_basePoint_hexstr, strlen(G1_basePoint_hexstr), 16);
+    mclBnG2_hashAndMapTo(&Q, "def", 3);
+
+    mclBnG1_mul(&xP, &P, &x);
+    mclBn_pairing(&pairing_res, &P, &Q);
+    mclBnGT_pow(&x_pairing_res, &pairing_res, &x);
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    for(int v = 0; v < 2; v++)
+    {
+
+        printf("eq_nipok_G1_GT (%s) : \n", versions_name[v]);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();    
+            eq_nipok_G1_GT(versions[v], &P, &xP, &pairing_res, &x_pairing_res, &x, &Rho, &sigma, &d);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+
+        print_trials_res(trials_res, nb_trials);
+
+        printf("eq_nipokver_G1_GT (%s) : \n", versions_name[v]);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            eq_nipokver_G1_GT(versions[v], &P, &xP, &pairing_res, &x_pairing_res, &Rho, &sigma, &d);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+
+        print_trials_res(trials_res, nb_trials);
+
+    }
+
+}
+
+void mesure_nipokver_batch(int nb_trials)
+{
+
+    const char * G1_basePoint_hexstr = "1 21a6d67ef250191fadba34a0a30160b9ac9264b6f95f63b3edbec3cf4b2e689db1bbb4e69a416a0b1e79239c0372e5cd70113c98d91f36b6980d 0118ea0460f7f7abb82b33676a7432a490eeda842cccfa7d788c659650426e6af77df11b8ae40eb80f475432c66600622ecaa8a5734d36fb03de";
+
+    size_t n_max = 256;
+    mclBnG1 P;
+    mclBnFr * l_sk = (mclBnFr *) malloc(n_max * sizeof(mclBnFr));
+    mclBnG1 * L_pk = (mclBnG1 *) malloc(n_max * sizeof(mclBnG1));
+    Lambda_ni * l_ni = (Lambda_ni *) malloc(n_max * sizeof(Lambda_ni));
+    mclBnG1 ** L_pk_ptr = (mclBnG1 **) malloc(n_max * sizeof(mclBnG1 *));
+    mclBnG1 ** Rho_ptr = (mclBnG1 **) malloc(n_max * sizeof(mclBnG1 *));
+    mclBnFr ** d_ptr = (mclBnFr **) malloc(n_max * sizeof(mclBnFr *));
+
+    mclBnG1_setStr(&P, G1_basePoint_hexstr, strlen(G1_basePoint_hexstr), 16);
+    for(size_t i = 0; i < n_max; i++)
+    {
+        a_key_gen(POK_FORMAT_COMMIT, &P, &l_sk[i], &L_pk[i], &l_ni[i]);
+        L_pk_ptr[i] = &L_pk[i];
+        Rho_ptr[i] = &l_ni[i].Rho;
+        d_ptr[i] = &l_ni[i].d;
+    }
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    for(size_t n = 2; n <= n_max; n *= 2)
+    {
+
+        printf("nipokver_G1 (%zu proofs, one by one) : \n", n);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            for(size_t j = 0; j < n; j++)
+            {
+                nipokver_G1(&P, L_pk_ptr[j], Rho_ptr[j], d_ptr[j]);
+            }
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        printf("nipokver_G1_batch (%zu proofs) : \n", n);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            nipokver_G1_batch(&P, n, L_pk_ptr, Rho_ptr, d_ptr, NULL);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+    }
+
+    free(l_sk);
+    free(L_pk);
+    free(l_ni);
+    free(L_pk_ptr);
+    free(Rho_ptr);
+    free(d_ptr);
+
+}
+
+void mesure_verify_mxy_batch(int nb_trials)
+{
+
+    const char * G2_basePoint_hexstr = "1 0257ccc85b58dda0dfb38e3a8cbdc5482e0337e7c1cd96ed61c913820408208f9ad2699bad92e0032ae1f0aa6a8b48807695468e3d934ae1e4df 1d2e4343e8599102af8edca849566ba3c98e2a354730cbed9176884058b18134dd86bae555b783718f50af8b59bf7e850e9b73108ba6aa8cd283 0a0650439da22c1979517427a20809eca035634706e23c3fa7a6bb42fe810f1399a1f41c9ddae32e03695a140e7b11d7c3376e5b68df0db7154e 073ef0cbd438cbe0172c8ae37306324d44d5e6b0c69ac57b393f1ab370fd725cc647692444a04ef87387aa68d53743493b9eba14cc552ca2a93a";
+
+    size_t batch_sizes[] = {1, 2, 3, 4, 6, 8, 12, 16, 32, 64};
+    size_t nb_batch_sizes = sizeof(batch_sizes) / sizeof(size_t);
+    size_t k_max = batch_sizes[nb_batch_sizes - 1];
+    size_t k_pays_off = 0;
+    size_t omega_len = 4 * sizeof(uuid_t);
+    mclBnG2 Q;
+    mclBnFr * y = (mclBnFr *) malloc(k_max * sizeof(mclBnFr));
+    mclBnG2 * yQ = (mclBnG2 *) malloc(k_max * sizeof(mclBnG2));
+    XY_ni * y_ni = (XY_ni *) malloc(k_max * sizeof(XY_ni));
+    unsigned char * omega = (unsigned char *) malloc(k_max * omega_len * sizeof(unsigned char));
+    mclBnG2 ** yQ_ptr = (mclBnG2 **) malloc(k_max * sizeof(mclBnG2 *));
+    XY_ni ** y_ni_ptr = (XY_ni **) malloc(k_max * sizeof(XY_ni *));
+    unsigned char ** omega_ptr = (unsigned char **) malloc(k_max * sizeof(unsigned char *));
+    size_t * omega_len_arr = (size_t *) malloc(k_max * sizeof(size_t));
+    int * res = (int *) malloc(k_max * sizeof(int));
+
+    // One session per index, each with its own omega
+    mclBnG2_setStr(&Q, G2_basePoint_hexstr, strlen(G2_basePoint_hexstr), 16);
+    for(size_t i = 0; i < k_max; i++)
+    {
+        omega_ptr[i] = omega + (i * omega_len);
+        omega_len_arr[i] = omega_len;
+        for(size_t j = 0; j < 4; j++)
+        {
+            uuid_generate_random(omega_ptr[i] + (j * sizeof(uuid_t)));
+        }
+        ake_b_get_my(POK_FORMAT_COMMIT, &Q, &y[i], omega_ptr[i], omega_len, &yQ[i], &y_ni[i]);
+        yQ_ptr[i] = &yQ[i];
+        y_ni_ptr[i] = &y_ni[i];
+    }
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    for(size_t b = 0; b < nb_batch_sizes; b++)
+    {
+
+        size_t k = batch_sizes[b];
+
+        printf("verify_my (%zu sessions, one by one) : \n", k);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            for(size_t j = 0; j < k; j++)
+            {
+                verify_my(&Q, yQ_ptr[j], omega_ptr[j], omega_len, y_ni_ptr[j]);
+            }
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        double time_single = print_trials_res(trials_res, nb_trials);
+
+        printf("verify_mxy_batch (%zu sessions) : \n", k);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            verify_mxy_batch(&Q, k, yQ_ptr, y_ni_ptr, omega_ptr, omega_len_arr, res);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        double time_batch = print_trials_res(trials_res, nb_trials);
+
+        if(k_pays_off == 0 && time_batch < time_single)
+        {
+            k_pays_off = k;
+        }
+
+    }
+
+    if(k_pays_off != 0)
+    {
+        printf("Batch verification of mx/my pays off from %zu sessions\n\n", k_pays_off);
+    }
+    else
+    {
+        printf("Batch verification of mx/my does not pay off up to %zu sessions\n\n", k_max);
+    }
+
+    free(y);
+    free(yQ);
+    free(y_ni);
+    free(omega);
+    free(yQ_ptr);
+    free(y_ni_ptr);
+    free(omega_ptr);
+    free(omega_len_arr);
+    free(res);
+
+}
+
+double mesure_ake_a_get_mx(int format, mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, X_eq_ni * x_eq_ni, int nb_trials)
 {
 
     double trials_res[nb_trials];
@@ -300,7 +825,7 @@ double mesure_ake_a_get_mx(mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_a_get_mx(P, Q, x, omega, omega_len, xP, xQ, x_ni);
+        ake_a_get_mx(format, P, Q, x, omega, omega_len, xP, xQ, x_ni, x_eq_ni);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -309,17 +834,19 @@ double mesure_ake_a_get_mx(mclBnG1 * P, mclBnG2 * Q, mclBnFr * x, unsigned char
 
 }
 
-double mesure_verify_mx(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, unsigned char * omega, size_t omega_len, XY_ni * x_ni, int nb_trials) 
+double mesure_verify_mx(mclBnG1 * P, mclBnG2 * Q, LikeSession * session, X_eq_ni * x_eq_ni, int nb_trials)
 {
   
     double trials_res[nb_trials];
     clock_t begin;
     clock_t end;
 
+    // Each session computes the lines of its xQ once
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        verify_mx(P, xP, Q, xQ, omega, omega_len, x_ni);
+        g2_lines_free(&session->xQ_lines);
+        verify_mx(P, Q, session, x_eq_ni);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -328,7 +855,7 @@ double mesure_verify_mx(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * Q, mclBnG2 * xQ, un
 
 }
 
-double mesure_ake_b_get_my(mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni, int nb_trials)
+double mesure_ake_b_get_my(int format, mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size_t omega_len, mclBnG2 * yQ, XY_ni * y_ni, int nb_trials)
 {
 
     double trials_res[nb_trials];
@@ -338,7 +865,7 @@ double mesure_ake_b_get_my(mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_b_get_my(Q, y, omega, omega_len, yQ, y_ni);
+        ake_b_get_my(format, Q, y, omega, omega_len, yQ, y_ni);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -347,7 +874,7 @@ double mesure_ake_b_get_my(mclBnG2 * Q, mclBnFr * y, unsigned char * omega, size
 
 }
 
-double mesure_ake_b_get_sigma_Y_1(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1, size_t sig_len, int nb_trials)
+double mesure_ake_b_get_sigma_Y_1(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, int nb_trials)
 {
 
     double trials_res[nb_trials];
@@ -357,7 +884,9 @@ double mesure_ake_b_get_sigma_Y_1(char * priv_key_path, unsigned char * omega, s
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_b_get_sigma_Y_1(priv_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sig_len);
+        // First sigma function of B, the session is serialized here
+        like_session_reset(session);
+        ake_b_get_sigma_Y_1(priv_key, session, sigma_Y_1);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -385,7 +914,7 @@ double mesure_verify_my(mclBnG2 * Q, mclBnG2 * yQ, unsigned char * omega, size_t
 
 }
 
-double mesure_verify_sigma_Y_1(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1, size_t sig_len, int nb_trials)
+double mesure_verify_sigma_Y_1(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, int nb_trials)
 {
 
     double trials_res[nb_trials];
@@ -395,7 +924,9 @@ double mesure_verify_sigma_Y_1(char * pub_key_path, unsigned char * omega, size_
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        verify_sigma_Y_1(pub_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sig_len);
+        // First sigma function of A and O, the session is serialized here
+        like_session_reset(session);
+        verify_sigma_Y_1(pub_key, session, sigma_Y_1);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -404,7 +935,7 @@ double mesure_verify_sigma_Y_1(char * pub_key_path, unsigned char * omega, size_
 
 }
 
-double mesure_ake_a_get_sigma_X(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, size_t sig_len, int nb_trials)
+double mesure_ake_a_get_sigma_X(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -414,7 +945,7 @@ double mesure_ake_a_get_sigma_X(char * priv_key_path, unsigned char * omega, siz
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_a_get_sigma_X(priv_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sigma_X, sig_len);
+        ake_a_get_sigma_X(priv_key, session, sigma_Y_1, sigma_X);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -423,7 +954,7 @@ double mesure_ake_a_get_sigma_X(char * priv_key_path, unsigned char * omega, siz
   
 }
 
-double mesure_verify_sigma_X(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, size_t sig_len, int nb_trials)
+double mesure_verify_sigma_X(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -433,7 +964,7 @@ double mesure_verify_sigma_X(char * pub_key_path, unsigned char * omega, size_t
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        verify_sigma_X(pub_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sigma_X, sig_len);
+        verify_sigma_X(pub_key, session, sigma_Y_1, sigma_X);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -442,7 +973,7 @@ double mesure_verify_sigma_X(char * pub_key_path, unsigned char * omega, size_t
   
 }
 
-double mesure_ake_b_get_sigma_Y_2(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, int nb_trials)
+double mesure_ake_b_get_sigma_Y_2(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -452,7 +983,7 @@ double mesure_ake_b_get_sigma_Y_2(char * priv_key_path, unsigned char * omega, s
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_b_get_sigma_Y_2(priv_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
+        ake_b_get_sigma_Y_2(priv_key, session, sigma_Y_1, sigma_X, sigma_Y_2);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -461,7 +992,7 @@ double mesure_ake_b_get_sigma_Y_2(char * priv_key_path, unsigned char * omega, s
   
 }
 
-double mesure_verify_sigma_Y_2(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, int nb_trials)
+double mesure_verify_sigma_Y_2(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -471,7 +1002,7 @@ double mesure_verify_sigma_Y_2(char * pub_key_path, unsigned char * omega, size_
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        verify_sigma_Y_2(pub_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
+        verify_sigma_Y_2(pub_key, session, sigma_Y_1, sigma_X, sigma_Y_2);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -480,7 +1011,7 @@ double mesure_verify_sigma_Y_2(char * pub_key_path, unsigned char * omega, size_
   
 }
 
-double mesure_ake_a_get_shared_key(mclBnG1 * L_pk, mclBnG2 * yQ, mclBnFr * x, mclBnGT * ka, int nb_trials)
+double mesure_ake_a_get_shared_key(AggregateKey * L_pk, LikeSession * session, mclBnFr * x, mclBnGT * ka, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -490,7 +1021,7 @@ double mesure_ake_a_get_shared_key(mclBnG1 * L_pk, mclBnG2 * yQ, mclBnFr * x, mc
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_a_get_shared_key(L_pk, yQ, x, ka);
+        ake_a_get_shared_key(L_pk, session, x, ka);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -499,7 +1030,7 @@ double mesure_ake_a_get_shared_key(mclBnG1 * L_pk, mclBnG2 * yQ, mclBnFr * x, mc
   
 }
 
-double mesure_ake_b_get_shared_key(mclBnG1 * L_pk, mclBnG2 * xQ, mclBnFr * y, mclBnGT * kb, int nb_trials)
+double mesure_ake_b_get_shared_key(AggregateKey * L_pk, LikeSession * session, mclBnFr * y, mclBnGT * kb, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -509,7 +1040,7 @@ double mesure_ake_b_get_shared_key(mclBnG1 * L_pk, mclBnG2 * xQ, mclBnFr * y, mc
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_b_get_shared_key(L_pk, xQ, y, kb);
+        ake_b_get_shared_key(L_pk, session, y, kb);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -518,7 +1049,131 @@ double mesure_ake_b_get_shared_key(mclBnG1 * L_pk, mclBnG2 * xQ, mclBnFr * y, mc
   
 }
 
-double mesure_ake_O_get_sst(char * priv_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, SST * sst, int nb_trials)
+/*
+ * Check and time the shared key derivations of A and B against the former e(L_pk, Q')^x path
+ * The table of L_pk must have been built with aggregate_key_sync
+ */
+void mesure_shared_key_paths(AggregateKey * agg, LikeSession * session, mclBnFr * x, mclBnFr * y, int nb_trials)
+{
+
+    mclBnG1 * L_pk = &agg->L_pk;
+    mclBnG2 * xQ = &session->xQ;
+    mclBnG2 * yQ = &session->yQ;
+    mclBnG1 xyL_pk;
+    mclBnGT ka, kb, ka_ref, kb_ref;
+    int check_ok = 1;
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    // e(x * L_pk, yQ) == e(L_pk, yQ)^x and e(y * L_pk, xQ) == e(L_pk, xQ)^y
+    ake_a_get_shared_key(agg, session, x, &ka);
+    ake_b_get_shared_key(agg, session, y, &kb);
+    mclBn_pairing(&ka_ref, L_pk, yQ);
+    mclBnGT_pow(&ka_ref, &ka_ref, x);
+    mclBn_pairing(&kb_ref, L_pk, xQ);
+    mclBnGT_pow(&kb_ref, &kb_ref, y);
+    check_ok &= mclBnGT_isEqual(&ka, &ka_ref);
+    check_ok &= mclBnGT_isEqual(&kb, &kb_ref);
+    check_ok &= mclBnGT_isEqual(&ka, &kb);
+
+    printf("shared key check against e(L_pk, Q')^x : %s\n\n", check_ok ? "OK" : "FAILED");
+
+    printf("shared key A, e(L_pk, yQ)^x (GT exponentiation) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        mclBn_pairing(&ka_ref, L_pk, yQ);
+        mclBnGT_pow(&ka_ref, &ka_ref, x);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_a_ref = print_trials_res(trials_res, nb_trials);
+
+    printf("shared key A, e(x * L_pk, yQ) (G1 multiplication, no table) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        mclBnG1_mul(&xyL_pk, L_pk, x);
+        mclBn_pairing(&ka, &xyL_pk, yQ);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    print_trials_res(trials_res, nb_trials);
+
+    printf("shared key A, ake_a_get_shared_key (L_pk table) : \n");
+    double time_a = mesure_ake_a_get_shared_key(agg, session, x, &ka, nb_trials);
+
+    printf("shared key B, e(L_pk, xQ)^y (GT exponentiation) : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        mclBn_pairing(&kb_ref, L_pk, xQ);
+        mclBnGT_pow(&kb_ref, &kb_ref, y);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_b_ref = print_trials_res(trials_res, nb_trials);
+
+    printf("shared key B, ake_b_get_shared_key (L_pk table, lines of xQ kept in the session by verify_mx) : \n");
+    double time_b = mesure_ake_b_get_shared_key(agg, session, y, &kb, nb_trials);
+
+    printf("shared key latency cut, A : %f, B : %f\n\n", time_a_ref - time_a, time_b_ref - time_b);
+
+}
+
+/*
+ * Time the two pairings of B against xQ for one session, e(xP, Q) == e(P, xQ) in verify_mx and kb,
+ * with a plain Miller loop for each against the lines of xQ computed by verify_mx and reused by ake_b_get_shared_key
+ * The table of L_pk must have been built with aggregate_key_sync
+ */
+void mesure_xQ_lines(mclBnG1 * P, mclBnG2 * Q, AggregateKey * agg, LikeSession * session, mclBnFr * y, int nb_trials)
+{
+
+    mclBnG1 yL_pk;
+    mclBnG1 pairing_P[2];
+    mclBnG2 pairing_Q[2];
+    mclBnGT kb;
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    printf("B, verify_mx then e(y * L_pk, xQ), plain Miller loops for xQ : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        sokver_G2(Q, &session->xQ, &session->x_ni.Rho, &session->x_ni.d, session->omega, session->omega_len);
+        pairing_P[0] = session->xP;
+        mclBnG1_neg(&pairing_P[1], P);
+        pairing_Q[0] = *Q;
+        pairing_Q[1] = session->xQ;
+        pairing_product_is_one(pairing_P, pairing_Q, 2);
+        mclBnG1_mul(&yL_pk, &agg->L_pk, y);
+        mclBn_pairing(&kb, &yL_pk, &session->xQ);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_ref = print_trials_res(trials_res, nb_trials);
+
+    printf("B, verify_mx then ake_b_get_shared_key, lines of xQ computed once per session : \n");
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        g2_lines_free(&session->xQ_lines);
+        verify_mx(P, Q, session, NULL);
+        ake_b_get_shared_key(agg, session, y, &kb);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_lines = print_trials_res(trials_res, nb_trials);
+
+    printf("B latency cut by the lines of xQ and the L_pk table : %f\n\n", time_ref - time_lines);
+
+}
+
+double mesure_ake_O_get_sst(Ed25519Key * priv_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, SST * sst, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -528,7 +1183,7 @@ double mesure_ake_O_get_sst(char * priv_key_path, unsigned char * omega, size_t
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        ake_O_get_sst(priv_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, sst);
+        ake_O_get_sst(priv_key, session, sigma_Y_1, sigma_X, sigma_Y_2, sst);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
         free(sst->m);
@@ -539,7 +1194,7 @@ double mesure_ake_O_get_sst(char * priv_key_path, unsigned char * omega, size_t
   
 }
 
-double mesure_verify_sst(char * pub_key_path, unsigned char * omega, size_t omega_len, mclBnG1 * xP, mclBnG2 * xQ, XY_ni * x_ni, mclBnG2 * yQ, XY_ni * y_ni, unsigned char * sigma_Y_1 , unsigned char * sigma_X, unsigned char * sigma_Y_2, size_t sig_len, SST * sst, int nb_trials)
+double mesure_verify_sst(Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, unsigned char * sigma_X, unsigned char * sigma_Y_2, SST * sst, int nb_trials)
 {
   
     double trials_res[nb_trials];
@@ -549,7 +1204,7 @@ double mesure_verify_sst(char * pub_key_path, unsigned char * omega, size_t omeg
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        verify_sst(pub_key_path, omega, omega_len, xP, xQ, x_ni, yQ, y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, sst);
+        verify_sst(pub_key, session, sigma_Y_1, sigma_X, sigma_Y_2, sst);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -558,7 +1213,7 @@ double mesure_verify_sst(char * pub_key_path, unsigned char * omega, size_t omeg
   
 }
 
-double mesure_verify_L_ni_for_2L(mclBnG1 * P, mclBnG1 * L1_pk, Lambda_ni * l1_ni, mclBnG1 * L2_pk, Lambda_ni * l2_ni, int nb_trials)
+double mesure_verify_L_ni(mclBnG1 * P, size_t n, mclBnG1 * Li_pk, Lambda_ni * li_ni, int nb_trials)
 {
    
     double trials_res[nb_trials];
@@ -568,7 +1223,7 @@ double mesure_verify_L_ni_for_2L(mclBnG1 * P, mclBnG1 * L1_pk, Lambda_ni * l1_ni
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        verify_L_ni(P, 4, L1_pk, l1_ni, L2_pk, l2_ni);
+        verify_L_ni(P, n, Li_pk, li_ni);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -577,7 +1232,26 @@ double mesure_verify_L_ni_for_2L(mclBnG1 * P, mclBnG1 * L1_pk, Lambda_ni * l1_ni
      
 }
 
-double mesure_tdgen_get_li_T1_for_2L(mclBnG1 * xP, mclBnG2 * yQ, mclBnFr * l1_sk, mclBnGT * l1_T1, mclBnFr * l2_sk, mclBnGT * l2_T1, int nb_trials)
+double mesure_verify_L_ni_cached(KeyCache * cache, mclBnG1 * P, size_t n, mclBnG1 * Li_pk, Lambda_ni * li_ni, int nb_trials)
+{
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        verify_L_ni_cached(cache, P, n, Li_pk, li_ni);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+
+    return print_trials_res(trials_res, nb_trials);
+
+}
+
+double mesure_tdgen_get_li_T1(LikeSession * session, size_t n, mclBnFr * li_sk, mclBnGT * li_T1, int nb_trials)
 {
    
     double trials_res[nb_trials];
@@ -587,7 +1261,9 @@ double mesure_tdgen_get_li_T1_for_2L(mclBnG1 * xP, mclBnG2 * yQ, mclBnFr * l1_sk
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        tdgen_get_li_T1(xP, yQ, 4, l1_sk, l1_T1, l2_sk, l2_T1);
+        // First use of e(xP, yQ) in the session, the pairing is computed here
+        like_session_reset(session);
+        tdgen_get_li_T1(session, n, li_sk, li_T1);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -596,7 +1272,7 @@ double mesure_tdgen_get_li_T1_for_2L(mclBnG1 * xP, mclBnG2 * yQ, mclBnFr * l1_sk
      
 }
 
-double mesure_tdgen_get_li_T2_for_2L(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, mclBnG1 * L1_pk, mclBnFr * l1_sk, mclBnGT * l1_T1, Lambda_eq_ni * l1_T2, mclBnG1 * L2_pk, mclBnFr * l2_sk, mclBnGT * l2_T1, Lambda_eq_ni * l2_T2, int nb_trials)
+double mesure_tdgen_get_li_T2(mclBnG1 * P, LikeSession * session, size_t n, mclBnG1 * Li_pk, mclBnFr * li_sk, mclBnGT * li_T1, Lambda_eq_ni * li_T2, int nb_trials)
 {
     
     double trials_res[nb_trials];
@@ -606,7 +1282,7 @@ double mesure_tdgen_get_li_T2_for_2L(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, mc
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        tdgen_get_li_T2(P, xP, yQ, 8, L1_pk, l1_sk, l1_T1, l1_T2, L2_pk, l2_sk, l2_T1, l2_T2);
+        tdgen_get_li_T2(P, session, n, Li_pk, li_sk, li_T1, li_T2);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -615,7 +1291,7 @@ double mesure_tdgen_get_li_T2_for_2L(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, mc
        
 }
 
-double mesure_verify_li_T2_for_2L(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, mclBnG1 * L1_pk, mclBnGT * l1_T1, Lambda_eq_ni * l1_T2, mclBnG1 * L2_pk, mclBnGT * l2_T1, Lambda_eq_ni * l2_T2, int nb_trials)
+double mesure_verify_li_T2(mclBnG1 * P, LikeSession * session, size_t n, mclBnG1 * Li_pk, mclBnGT * li_T1, Lambda_eq_ni * li_T2, int nb_trials)
 {
       
     double trials_res[nb_trials];
@@ -625,7 +1301,9 @@ double mesure_verify_li_T2_for_2L(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, mclBn
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        verify_li_T2(P, xP, yQ, 6, L1_pk, l1_T1, l1_T2, L2_pk, l2_T1, l2_T2);
+        // The opener computes e(xP, yQ) in its own session
+        like_session_reset(session);
+        verify_li_T2(P, session, n, Li_pk, li_T1, li_T2);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -634,7 +1312,7 @@ double mesure_verify_li_T2_for_2L(mclBnG1 * P, mclBnG1 * xP, mclBnG2 * yQ, mclBn
      
 }
 
-double mesure_open_get_shared_key_for_2(mclBnGT * k, mclBnGT * l1_T1, mclBnGT * l2_T1, int nb_trials)
+double mesure_open_get_shared_key(mclBnGT * k, size_t n, mclBnGT * li_T1, int nb_trials)
 {
       
     double trials_res[nb_trials];
@@ -644,7 +1322,7 @@ double mesure_open_get_shared_key_for_2(mclBnGT * k, mclBnGT * l1_T1, mclBnGT *
     for(int i = 0; i < nb_trials; i++)
     {
         begin = clock();
-        open_get_shared_key(k, 2, l1_T1, l2_T1);
+        open_get_shared_key(k, n, li_T1);
         end = clock();
         trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
     }
@@ -653,6 +1331,567 @@ double mesure_open_get_shared_key_for_2(mclBnGT * k, mclBnGT * l1_T1, mclBnGT *
      
 }
 
+/*
+ * Time TDGen with one e(xP, yQ) per authority, as before the session cache, against tdgen_get_li_T1 and tdgen_get_li_T2
+ * which compute it once per session, then the li_T2 check of Open with its own e(xP, yQ), as before the cache,
+ * against verify_li_T2 which reuses the e(xP, yQ) kept in the session by TDGen
+ * saved_TDGen, saved_Open : receive the measured mean time saved by the cache, in ms
+ */
+void mesure_xy_pairing_cache(mclBnG1 * P, LikeSession * session, size_t n, mclBnG1 * Li_pk, mclBnFr * li_sk, Lambda_eq_ni * li_T2, double * saved_TDGen, double * saved_Open, int nb_trials)
+{
+
+    mclBnGT pairing_res;
+    mclBnGT * li_T1 = (mclBnGT *) malloc(n * sizeof(mclBnGT));
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    *saved_TDGen = 0.0;
+    *saved_Open = 0.0;
+    if(li_T1 == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        return;
+    }
+
+    printf("TDGen (%zu Authorities), e(xP, yQ) for each authority in T1 and T2 : \n", n);
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        for(size_t j = 0; j < n; j++)
+        {
+            mclBn_pairing(&pairing_res, &session->xP, &session->yQ);
+            mclBnGT_pow(&li_T1[j], &pairing_res, &li_sk[j]);
+        }
+        for(size_t j = 0; j < n; j++)
+        {
+            mclBn_pairing(&pairing_res, &session->xP, &session->yQ);
+            eq_nipok_G1_GT(li_T2[j].version, P, &Li_pk[j], &pairing_res, &li_T1[j], &li_sk[j], &li_T2[j].Rho, &li_T2[j].Sigma, &li_T2[j].d);
+        }
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_tdgen_ref = print_trials_res(trials_res, nb_trials);
+
+    printf("TDGen (%zu Authorities), e(xP, yQ) kept in the session : \n", n);
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        like_session_reset(session);
+        tdgen_get_li_T1(session, n, li_sk, li_T1);
+        tdgen_get_li_T2(P, session, n, Li_pk, li_sk, li_T1, li_T2);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_tdgen = print_trials_res(trials_res, nb_trials);
+
+    printf("Open li_T2 check (%zu Authorities), e(xP, yQ) computed once : \n", n);
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        mclBn_pairing(&pairing_res, &session->xP, &session->yQ);
+        for(size_t j = 0; j < n; j++)
+        {
+            eq_nipokver_G1_GT(li_T2[j].version, P, &Li_pk[j], &pairing_res, &li_T1[j], &li_T2[j].Rho, &li_T2[j].Sigma, &li_T2[j].d);
+        }
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_open_ref = print_trials_res(trials_res, nb_trials);
+
+    printf("Open li_T2 check (%zu Authorities), verify_li_T2 with e(xP, yQ) kept in the session by TDGen : \n", n);
+    for(int i = 0; i < nb_trials; i++)
+    {
+        begin = clock();
+        verify_li_T2(P, session, n, Li_pk, li_T1, li_T2);
+        end = clock();
+        trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+    }
+    double time_open = print_trials_res(trials_res, nb_trials);
+
+    *saved_TDGen = time_tdgen_ref - time_tdgen;
+    *saved_Open = time_open_ref - time_open;
+
+    free(li_T1);
+
+}
+
+void mesure_authorities(mclBnG1 * P, LikeSession * session, int nb_trials)
+{
+
+    size_t n_max = 1024;
+    mclBnG1 L_pk;
+    AggregateKey agg;
+    KeyCache key_cache;
+    char key_cache_path[] = "keys/perfs_verified_keys.cache";
+    mclBnGT k, k_ref;
+    mclBnG1 * Li_pk = (mclBnG1 *) malloc(n_max * sizeof(mclBnG1));
+    mclBnFr * li_sk = (mclBnFr *) malloc(n_max * sizeof(mclBnFr));
+    Lambda_ni * li_ni = (Lambda_ni *) malloc(n_max * sizeof(Lambda_ni));
+    mclBnGT * li_T1 = (mclBnGT *) malloc(n_max * sizeof(mclBnGT));
+    Lambda_eq_ni * li_T2 = (Lambda_eq_ni *) malloc(n_max * sizeof(Lambda_eq_ni));
+
+    for(size_t i = 0; i < n_max; i++)
+    {
+        a_key_gen(POK_FORMAT_COMMIT, P, &li_sk[i], &Li_pk[i], &li_ni[i]);
+    }
+
+    key_cache_open(&key_cache, key_cache_path, 1);
+
+    for(size_t n = 2; n <= n_max; n *= 2)
+    {
+        // The per-authority steps grow with n, fewer trials for large n
+        int trials = (nb_trials * 2) / (int) n;
+        if(trials < 2)
+        {
+            trials = 2;
+        }
+
+        printf("verify_L_ni (%zu Authorities) : \n", n);
+        mesure_verify_L_ni(P, n, Li_pk, li_ni, trials);
+
+        // The first call verifies and caches the keys added since the previous n
+        printf("verify_L_ni_cached (%zu Authorities, all in the cache) : \n", n);
+        verify_L_ni_cached(&key_cache, P, n, Li_pk, li_ni);
+        mesure_verify_L_ni_cached(&key_cache, P, n, Li_pk, li_ni, nb_trials);
+
+        printf("ake_precalc_add_lipk (%zu Authorities) : \n", n);
+        double trials_res[nb_trials];
+        clock_t begin;
+        clock_t end;
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            ake_precalc_add_lipk(&L_pk, n, Li_pk);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        // Rotate the key of the first authority back and forth, L_pk is then updated in place
+        printf("aggregate_key_rotate (%zu Authorities) : \n", n);
+        aggregate_key_init(&agg, n, Li_pk);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            if(i % 2 == 0)
+            {
+                aggregate_key_rotate(&agg, &Li_pk[0], &Li_pk[n - 1]);
+            }
+            else
+            {
+                aggregate_key_rotate(&agg, &Li_pk[n - 1], &Li_pk[0]);
+            }
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+        if(nb_trials % 2 == 1)
+        {
+            aggregate_key_rotate(&agg, &Li_pk[n - 1], &Li_pk[0]);
+        }
+        if(mclBnG1_isEqual(&agg.L_pk, &L_pk) != 1)
+        {
+            printf("aggregate_key_rotate (%zu Authorities) : keys not equal\n\n", n);
+        }
+        aggregate_key_free(&agg);
+
+        printf("tdgen_get_li_T1 (%zu Authorities) : \n", n);
+        mesure_tdgen_get_li_T1(session, n, li_sk, li_T1, trials);
+
+        printf("tdgen_get_li_T2 (%zu Authorities) : \n", n);
+        mesure_tdgen_get_li_T2(P, session, n, Li_pk, li_sk, li_T1, li_T2, trials);
+
+        printf("verify_li_T2 (%zu Authorities) : \n", n);
+        mesure_verify_li_T2(P, session, n, Li_pk, li_T1, li_T2, trials);
+
+        printf("open_get_shared_key (%zu Authorities) : \n", n);
+        mesure_open_get_shared_key(&k, n, li_T1, nb_trials);
+
+        // k must be e(xP, yQ)^(l1_sk + ... + ln_sk)
+        mclBnFr sk_sum;
+        mclBnFr_clear(&sk_sum);
+        for(size_t i = 0; i < n; i++)
+        {
+            mclBnFr_add(&sk_sum, &sk_sum, &li_sk[i]);
+        }
+        like_session_get_xy_pairing(session, &k_ref);
+        mclBnGT_pow(&k_ref, &k_ref, &sk_sum);
+        if(mclBnGT_isEqual(&k, &k_ref) != 1)
+        {
+            printf("open_get_shared_key (%zu Authorities) : keys not equal\n\n", n);
+        }
+    }
+
+    key_cache_close(&key_cache);
+    unlink(key_cache_path);
+
+    free(Li_pk);
+    free(li_sk);
+    free(li_ni);
+    free(li_T1);
+    free(li_T2);
+
+}
+
+/*
+ * Time the operator checks of mx, my and sigma_Y_1 in the former order (verify_mx, verify_my, verify_sigma_Y_1)
+ * against ake_O_verify_mxy, on the valid session and with a forged sigma_Y_1
+ */
+void mesure_operator_checks(mclBnG1 * P, mclBnG2 * Q, Ed25519Key * pub_key, LikeSession * session, unsigned char * sigma_Y_1, int nb_trials)
+{
+
+    VerifyStats stats;
+    unsigned char forged[ED25519_SIG_LENGTH];
+    unsigned char * sigs[2] = {sigma_Y_1, forged};
+    char * sigs_name[2] = {"valid", "forged sigma_Y_1"};
+    int accepted;
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    memcpy(forged, sigma_Y_1, ED25519_SIG_LENGTH);
+    forged[0] ^= 1;
+    verify_stats_init(&stats);
+
+    for(int s = 0; s < 2; s++)
+    {
+        printf("operator checks, verify_mx, verify_my, verify_sigma_Y_1 (%s) : \n", sigs_name[s]);
+        accepted = 1;
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            accepted &= (verify_mx(P, Q, session, NULL) == LIKE_OK
+                && verify_my(Q, &session->yQ, session->omega, session->omega_len, &session->y_ni) == LIKE_OK
+                && verify_sigma_Y_1(pub_key, session, sigs[s]) == LIKE_OK);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+        if(accepted != (s == 0))
+        {
+            printf("operator checks (%s) : wrong result\n\n", sigs_name[s]);
+        }
+
+        printf("operator checks, ake_O_verify_mxy (%s) : \n", sigs_name[s]);
+        accepted = 1;
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = clock();
+            accepted &= (ake_O_verify_mxy(&stats, pub_key, P, Q, session, sigs[s], NULL) == LIKE_OK);
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+        if(accepted != (s == 0))
+        {
+            printf("ake_O_verify_mxy (%s) : wrong result\n\n", sigs_name[s]);
+        }
+    }
+
+    printf("ake_O_verify_mxy counters : %llu checked, %llu accepted, rejected at format %llu, sig %llu, schnorr %llu, pairing %llu\n\n",
+        (unsigned long long) stats.nb_checked, (unsigned long long) stats.nb_accepted,
+        (unsigned long long) stats.nb_rejected[LIKE_STAGE_FORMAT], (unsigned long long) stats.nb_rejected[LIKE_STAGE_SIG],
+        (unsigned long long) stats.nb_rejected[LIKE_STAGE_SCHNORR], (unsigned long long) stats.nb_rejected[LIKE_STAGE_PAIRING]);
+
+}
+
+/*
+ * Time the serialization of n points of G1 and G2 normalized one by one by mcl against G1_normalize_batch / G2_normalize_batch
+ * The points are copied from sums of P and Q before each trial, so that none of them is affine
+ */
+void mesure_normalize(mclBnG1 * P, mclBnG2 * Q, int nb_trials)
+{
+
+    size_t nb_points[] = {7, 1024};
+    size_t n_max = nb_points[(sizeof(nb_points) / sizeof(size_t)) - 1];
+    size_t len_G1 = mclBn_getG1ByteSize();
+    size_t len_G2 = len_G1 * 2;
+    mclBnG1 * src_G1 = (mclBnG1 *) malloc(n_max * sizeof(mclBnG1));
+    mclBnG2 * src_G2 = (mclBnG2 *) malloc(n_max * sizeof(mclBnG2));
+    mclBnG1 * work_G1 = (mclBnG1 *) malloc(n_max * sizeof(mclBnG1));
+    mclBnG2 * work_G2 = (mclBnG2 *) malloc(n_max * sizeof(mclBnG2));
+    mclBnG1 ** ptr_G1 = (mclBnG1 **) malloc(n_max * sizeof(mclBnG1 *));
+    mclBnG2 ** ptr_G2 = (mclBnG2 **) malloc(n_max * sizeof(mclBnG2 *));
+    unsigned char * buf_one = (unsigned char *) malloc(n_max * len_G2);
+    unsigned char * buf_batch = (unsigned char *) malloc(n_max * len_G2);
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    if(src_G1 == NULL || src_G2 == NULL || work_G1 == NULL || work_G2 == NULL || ptr_G1 == NULL || ptr_G2 == NULL || buf_one == NULL || buf_batch == NULL)
+    {
+        fprintf(stderr, "malloc failed\n");
+        goto err;
+    }
+
+    // src_i <-- (i + 2) * P, left in projective coordinates by the additions
+    mclBnG1_dbl(&src_G1[0], P);
+    mclBnG2_dbl(&src_G2[0], Q);
+    for(size_t i = 1; i < n_max; i++)
+    {
+        mclBnG1_add(&src_G1[i], &src_G1[i - 1], P);
+        mclBnG2_add(&src_G2[i], &src_G2[i - 1], Q);
+        ptr_G1[i] = &work_G1[i];
+        ptr_G2[i] = &work_G2[i];
+    }
+    ptr_G1[0] = &work_G1[0];
+    ptr_G2[0] = &work_G2[0];
+
+    for(size_t k = 0; k < sizeof(nb_points) / sizeof(size_t); k++)
+    {
+        size_t n = nb_points[k];
+
+        printf("Serialize %zu G1 points, one inversion each : \n", n);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            memcpy(work_G1, src_G1, n * sizeof(mclBnG1));
+            begin = clock();
+            for(size_t j = 0; j < n; j++)
+            {
+                mclBnG1_serialize(buf_one + (j * len_G1), len_G1, &work_G1[j]);
+            }
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        printf("Serialize %zu G1 points, G1_normalize_batch : \n", n);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            memcpy(work_G1, src_G1, n * sizeof(mclBnG1));
+            begin = clock();
+            G1_normalize_batch(ptr_G1, n);
+            for(size_t j = 0; j < n; j++)
+            {
+                mclBnG1_serialize(buf_batch + (j * len_G1), len_G1, &work_G1[j]);
+            }
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+        if(memcmp(buf_one, buf_batch, n * len_G1) != 0)
+        {
+            printf("G1_normalize_batch (%zu points) : wrong serialization\n\n", n);
+        }
+
+        printf("Serialize %zu G2 points, one inversion each : \n", n);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            memcpy(work_G2, src_G2, n * sizeof(mclBnG2));
+            begin = clock();
+            for(size_t j = 0; j < n; j++)
+            {
+                mclBnG2_serialize(buf_one + (j * len_G2), len_G2, &work_G2[j]);
+            }
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        printf("Serialize %zu G2 points, G2_normalize_batch : \n", n);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            memcpy(work_G2, src_G2, n * sizeof(mclBnG2));
+            begin = clock();
+            G2_normalize_batch(ptr_G2, n);
+            for(size_t j = 0; j < n; j++)
+            {
+                mclBnG2_serialize(buf_batch + (j * len_G2), len_G2, &work_G2[j]);
+            }
+            end = clock();
+            trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+        }
+        print_trials_res(trials_res, nb_trials);
+        if(memcmp(buf_one, buf_batch, n * len_G2) != 0)
+        {
+            printf("G2_normalize_batch (%zu points) : wrong serialization\n\n", n);
+        }
+    }
+
+    err:
+        free(src_G1);
+        free(src_G2);
+        free(work_G1);
+        free(work_G2);
+        free(ptr_G1);
+        free(ptr_G2);
+        free(buf_one);
+        free(buf_batch);
+
+}
+
+/*
+ * CPU time of the calling thread only, clock() would also count the refill threads of the pools
+ */
+double get_thread_time(void)
+{
+
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+
+}
+
+/*
+ * Time ake_a_get_mx and ake_b_get_my against their pooled versions, with pools filled before the timing
+ * The pooled proofs are checked by verify_mx and verify_my
+ */
+void mesure_pool(mclBnG1 * P, mclBnG2 * Q, unsigned char * omega, size_t omega_len, int nb_trials)
+{
+
+    EphemeralPool pool_A, pool_B;
+    LikeSession session;
+    mclBnFr x, y;
+    mclBnG1 xP;
+    mclBnG2 xQ, yQ;
+    XY_ni x_ni, y_ni;
+    int formats[2] = {POK_FORMAT_COMMIT, POK_FORMAT_COMPACT};
+    char * formats_name[2] = {"commit", "compact"};
+
+    double trials_res[nb_trials];
+    double begin;
+
+    if(like_session_init(&session, LIKE_SIG_TRANSCRIPT, omega, omega_len, ED25519_SIG_LENGTH) != LIKE_OK)
+    {
+        return;
+    }
+    if(pool_init(&pool_A, P, Q, nb_trials, LIKE_POOL_THREADS) != LIKE_OK)
+    {
+        like_session_free(&session);
+        return;
+    }
+    if(pool_init(&pool_B, NULL, Q, nb_trials, LIKE_POOL_THREADS) != LIKE_OK)
+    {
+        pool_free(&pool_A);
+        like_session_free(&session);
+        return;
+    }
+
+    for(int f = 0; f < 2; f++)
+    {
+        if(ake_a_get_mx_pooled(formats[f], &pool_A, &x, omega, omega_len, &session.xP, &session.xQ, &session.x_ni) != LIKE_OK
+            || verify_mx(P, Q, &session, NULL) != LIKE_OK)
+        {
+            printf("Pooled mx (%s) not valid\n", formats_name[f]);
+        }
+        if(ake_b_get_my_pooled(formats[f], &pool_B, &y, omega, omega_len, &yQ, &y_ni) != LIKE_OK
+            || verify_my(Q, &yQ, omega, omega_len, &y_ni) != LIKE_OK)
+        {
+            printf("Pooled my (%s) not valid\n", formats_name[f]);
+        }
+
+        printf("ake_a_get_mx (%s, online) : \n", formats_name[f]);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = get_thread_time();
+            ake_a_get_mx(formats[f], P, Q, &x, omega, omega_len, &xP, &xQ, &x_ni, NULL);
+            trials_res[i] = get_thread_time() - begin;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        printf("ake_a_get_mx_pooled (%s, full pool of %d) : \n", formats_name[f], nb_trials);
+        pool_wait_full(&pool_A);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = get_thread_time();
+            ake_a_get_mx_pooled(formats[f], &pool_A, &x, omega, omega_len, &xP, &xQ, &x_ni);
+            trials_res[i] = get_thread_time() - begin;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        printf("ake_b_get_my (%s, online) : \n", formats_name[f]);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = get_thread_time();
+            ake_b_get_my(formats[f], Q, &y, omega, omega_len, &yQ, &y_ni);
+            trials_res[i] = get_thread_time() - begin;
+        }
+        print_trials_res(trials_res, nb_trials);
+
+        printf("ake_b_get_my_pooled (%s, full pool of %d) : \n", formats_name[f], nb_trials);
+        pool_wait_full(&pool_B);
+        for(int i = 0; i < nb_trials; i++)
+        {
+            begin = get_thread_time();
+            ake_b_get_my_pooled(formats[f], &pool_B, &y, omega, omega_len, &yQ, &y_ni);
+            trials_res[i] = get_thread_time() - begin;
+        }
+        print_trials_res(trials_res, nb_trials);
+    }
+
+    pool_free(&pool_A);
+    pool_free(&pool_B);
+    like_session_free(&session);
+
+}
+
+void mesure_sig_modes(Ed25519Key * priv_key, Ed25519Key * pub_key, LikeSession * ref_session, int nb_trials)
+{
+
+    size_t id_len = sizeof(uuid_t);
+    size_t sig_len = ED25519_SIG_LENGTH;
+    int modes[2] = {LIKE_SIG_TRANSCRIPT, LIKE_SIG_CHAINED};
+    char * modes_name[2] = {"transcript", "chained"};
+    unsigned char sigma_Y_1[ED25519_SIG_LENGTH];
+    unsigned char sigma_X[ED25519_SIG_LENGTH];
+    unsigned char sigma_Y_2[ED25519_SIG_LENGTH];
+    LikeSession session;
+
+    double trials_res[nb_trials];
+    clock_t begin;
+    clock_t end;
+
+    // omega holds the ids of A, B and of the authorities
+    for(size_t nb_ids = 4; nb_ids <= 1026; nb_ids = (nb_ids - 2) * 8 + 2)
+    {
+        size_t omega_len = nb_ids * id_len;
+        unsigned char * omega = (unsigned char *) malloc(omega_len);
+        for(size_t j = 0; j < nb_ids; j++)
+        {
+            uuid_generate_random(omega + (j * id_len));
+        }
+
+        for(int m = 0; m < 2; m++)
+        {
+            if(like_session_init(&session, modes[m], omega, omega_len, sig_len) != LIKE_OK)
+            {
+                continue;
+            }
+            session.xP = ref_session->xP;
+            session.xQ = ref_session->xQ;
+            session.x_ni = ref_session->x_ni;
+            session.yQ = ref_session->yQ;
+            session.y_ni = ref_session->y_ni;
+
+            // Signatures and verifications of sigma_Y_1, sigma_X and sigma_Y_2 once the session is serialized
+            printf("sigma_Y_1, sigma_X, sigma_Y_2 sign and verify (%s, %zu ids in omega) : \n", modes_name[m], nb_ids);
+            for(int i = 0; i < nb_trials; i++)
+            {
+                begin = clock();
+                ake_b_get_sigma_Y_1(priv_key, &session, sigma_Y_1);
+                verify_sigma_Y_1(pub_key, &session, sigma_Y_1);
+                ake_a_get_sigma_X(priv_key, &session, sigma_Y_1, sigma_X);
+                verify_sigma_X(pub_key, &session, sigma_Y_1, sigma_X);
+                ake_b_get_sigma_Y_2(priv_key, &session, sigma_Y_1, sigma_X, sigma_Y_2);
+                verify_sigma_Y_2(pub_key, &session, sigma_Y_1, sigma_X, sigma_Y_2);
+                end = clock();
+                trials_res[i] = (double)(end - begin) / CLOCKS_PER_SEC;
+            }
+
+            print_trials_res(trials_res, nb_trials);
+
+            like_session_free(&session);
+        }
+
+        free(omega);
+    }
+
+}
+
 int main(int argc, char *argv[])
 {
 
@@ -678,11 +1917,17 @@ int main(int argc, char *argv[])
      * *****************************************************************/
 
     mesure_pairing(nb_trials);
+    mesure_pairing_product(nb_trials);
     mesure_arithmetic_EC(nb_trials);
+    mesure_fixed_base(nb_trials);
     mesure_edd25519(nb_trials);
+    mesure_challenge(nb_trials);
     mesure_sok(nb_trials);
     mesure_nipok(nb_trials);
     mesure_eqnipok(nb_trials);
+    mesure_eqnipok_GT(nb_trials);
+    mesure_nipokver_batch(nb_trials);
+    mesure_verify_mxy_batch(nb_trials);
 
     /*******************************************************************
      *                                                                 *
@@ -691,13 +1936,13 @@ int main(int argc, char *argv[])
      * *****************************************************************/
 
     // General Param
-    mclBnG1 P, xP;
-    mclBnG2 Q, xQ, yQ;
+    mclBnG1 P;
+    mclBnG2 Q;
     mclBnFr x, y; 
-    XY_ni x_ni, y_ni;
-    mclBnGT ka, kb, k, l1_T1, l2_T1;
+    LikeSession session;
+    X_eq_ni x_eq_ni;
+    mclBnGT ka, kb, k;
     SST sst;
-    Lambda_eq_ni l1_T2, l2_T2;
 
     // Id
     size_t id_len = sizeof(uuid_t);
@@ -716,9 +1961,14 @@ int main(int argc, char *argv[])
     char priv_key_B[] = "keys/b_priv_key.pem";
     char pub_key_O[] = "keys/o_pub_key.pem";
     char priv_key_O[] = "keys/o_priv_key.pem";
-    mclBnG1 L1_pk, L2_pk, L_pk;
-    mclBnFr l1_sk, l2_sk;
-    Lambda_ni l1_ni, l2_ni;
+    Ed25519Key sk_A, pk_A, sk_B, pk_B, sk_O, pk_O;
+    size_t nb_authorities = 2;
+    AggregateKey L_pk;
+    mclBnG1 Li_pk[nb_authorities];
+    mclBnFr li_sk[nb_authorities];
+    Lambda_ni li_ni[nb_authorities];
+    mclBnGT li_T1[nb_authorities];
+    Lambda_eq_ni li_T2[nb_authorities];
 
     // Sig buffer
     size_t sig_len = ED25519_SIG_LENGTH;
@@ -727,7 +1977,13 @@ int main(int argc, char *argv[])
     unsigned char * sigma_Y_2 = (unsigned char *) malloc(sig_len * sizeof(unsigned char));
 
     // Setup
-    setup(&P, &Q);
+    if(setup(&P, &Q) != LIKE_OK)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // normalize_init is called by setup
+    mesure_normalize(&P, &Q, nb_trials);
 
     //UKeyGen A
     u_o_key_gen(pub_key_A, priv_key_A);
@@ -738,160 +1994,187 @@ int main(int argc, char *argv[])
     // UKeyGen O
     u_o_key_gen(pub_key_O, priv_key_O);
 
-    // LambdaKeyGen L1
-    a_key_gen(&P, &l1_sk, &L1_pk, &l1_ni);
+    // The keys are read from their files once, out of the mesures
+    if(ed25519_key_load_priv(&sk_A, priv_key_A) != LIKE_OK || ed25519_key_load_pub(&pk_A, pub_key_A) != LIKE_OK
+        || ed25519_key_load_priv(&sk_B, priv_key_B) != LIKE_OK || ed25519_key_load_pub(&pk_B, pub_key_B) != LIKE_OK
+        || ed25519_key_load_priv(&sk_O, priv_key_O) != LIKE_OK || ed25519_key_load_pub(&pk_O, pub_key_O) != LIKE_OK)
+    {
+        return EXIT_FAILURE;
+    }
 
-    // LambdaKeyGen L2
-    a_key_gen(&P, &l2_sk, &L2_pk, &l2_ni);
+    // LambdaKeyGen L1, L2
+    for(size_t i = 0; i < nb_authorities; i++)
+    {
+        a_key_gen(POK_FORMAT_COMMIT, &P, &li_sk[i], &Li_pk[i], &li_ni[i]);
+    }
 
     // AKE Precal
-    verify_L_ni(&P, 4, &L1_pk, &l1_ni, &L2_pk, &l2_ni);
-    ake_precalc_add_lipk(&L_pk, 2, &L1_pk, &L2_pk);
+    if(verify_L_ni(&P, nb_authorities, Li_pk, li_ni) != LIKE_OK)
+    {
+        return EXIT_FAILURE;
+    }
+    aggregate_key_init(&L_pk, nb_authorities, Li_pk);
+    aggregate_key_sync(&L_pk);
     ake_precalc_get_omega(omega, 8, id_A, id_len, id_B, id_len, id_L1, id_len, id_L2, id_len);
+    if(like_session_init(&session, LIKE_SIG_TRANSCRIPT, omega, omega_len, sig_len) != LIKE_OK)
+    {
+        return EXIT_FAILURE;
+    }
+
+    // Mesure the mx equality proof mode, xP and xQ consistency checked by eq_nipok_G1_G2 instead of pairings
+    printf("ake_a_get_mx (eq_nipok mode) : \n");
+    mesure_ake_a_get_mx(POK_FORMAT_COMMIT, &P, &Q, &x, omega, omega_len, &session.xP, &session.xQ, &session.x_ni, &x_eq_ni, nb_trials);
+    printf("verify_mx (eq_nipok mode) : \n");
+    mesure_verify_mx(&P, &Q, &session, &x_eq_ni, nb_trials);
 
     // Mesure ake_a_get_mx
     printf("ake_a_get_mx : \n");
-    double time_ake_a_get_mx = mesure_ake_a_get_mx(&P, &Q, &x, omega, omega_len, &xP, &xQ, &x_ni, nb_trials);
+    double time_ake_a_get_mx = mesure_ake_a_get_mx(POK_FORMAT_COMMIT, &P, &Q, &x, omega, omega_len, &session.xP, &session.xQ, &session.x_ni, NULL, nb_trials);
 
     // A : ake_a_get_mx
-    ake_a_get_mx(&P, &Q, &x, omega, omega_len, &xP, &xQ, &x_ni);
+    ake_a_get_mx(POK_FORMAT_COMMIT, &P, &Q, &x, omega, omega_len, &session.xP, &session.xQ, &session.x_ni, NULL);
     total_time_A += time_ake_a_get_mx;
 
     // Mesure verify_mx
     printf("verify_mx : \n");
-    double time_verify_mx = mesure_verify_mx(&P, &xP, &Q, &xQ, omega, omega_len, &x_ni, nb_trials);
+    double time_verify_mx = mesure_verify_mx(&P, &Q, &session, NULL, nb_trials);
 
     // O : verify_mx
-    verify_mx(&P, &xP, &Q, &xQ, omega, omega_len, &x_ni);
+    verify_mx(&P, &Q, &session, NULL);
     total_time_O += time_verify_mx;
 
     // Mesure ake_b_get_my
     printf("ake_b_get_my : \n");
-    double time_ake_b_get_my = mesure_ake_b_get_my(&Q, &y, omega, omega_len, &yQ, &y_ni, nb_trials);
+    double time_ake_b_get_my = mesure_ake_b_get_my(POK_FORMAT_COMMIT, &Q, &y, omega, omega_len, &session.yQ, &session.y_ni, nb_trials);
 
     // Mesure ake_b_get_sigma_Y_1
     printf("ake_b_get_sigma_Y_1 : \n");
-    double time_ake_b_get_sigma_Y_1 = mesure_ake_b_get_sigma_Y_1(priv_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len, nb_trials);
+    double time_ake_b_get_sigma_Y_1 = mesure_ake_b_get_sigma_Y_1(&sk_B, &session, sigma_Y_1, nb_trials);
 
     // B : ake_b_get_my, verify_mx, ake_b_get_sigma_Y_1
-    verify_mx(&P, &xP, &Q, &xQ, omega, omega_len, &x_ni);
-    ake_b_get_my(&Q, &y, omega, omega_len, &yQ, &y_ni);
-    ake_b_get_sigma_Y_1(priv_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
+    verify_mx(&P, &Q, &session, NULL);
+    ake_b_get_my(POK_FORMAT_COMMIT, &Q, &y, omega, omega_len, &session.yQ, &session.y_ni);
+    like_session_reset(&session);
+    ake_b_get_sigma_Y_1(&sk_B, &session, sigma_Y_1);
     total_time_B += time_verify_mx + time_ake_b_get_my + time_ake_b_get_sigma_Y_1;
 
     // Mesure verify_my
     printf("verify_my : \n");
-    double time_verify_my = mesure_verify_my(&Q, &yQ, omega, omega_len, &y_ni, nb_trials);
+    double time_verify_my = mesure_verify_my(&Q, &session.yQ, omega, omega_len, &session.y_ni, nb_trials);
 
     // Mesure verify_sigma_Y_1
     printf("verify_sigma_Y_1 : \n");
-    double time_verify_sigma_Y_1 = mesure_verify_sigma_Y_1(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len, nb_trials);
+    double time_verify_sigma_Y_1 = mesure_verify_sigma_Y_1(&pk_B, &session, sigma_Y_1, nb_trials);
 
     // O : verify_my, verify_sigma_Y_1
-    verify_my(&Q, &yQ, omega, omega_len, &y_ni);
-    verify_sigma_Y_1(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
+    verify_my(&Q, &session.yQ, omega, omega_len, &session.y_ni);
+    verify_sigma_Y_1(&pk_B, &session, sigma_Y_1);
     total_time_O += time_verify_my + time_verify_sigma_Y_1;
 
     // Mesure ake_a_get_sigma_X
     printf("ake_a_get_sigma_X : \n");
-    double time_ake_a_get_sigma_X = mesure_ake_a_get_sigma_X(priv_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len, nb_trials);
+    double time_ake_a_get_sigma_X = mesure_ake_a_get_sigma_X(&sk_A, &session, sigma_Y_1, sigma_X, nb_trials);
 
     // A : verify_my, verify_sigma_Y_1, ake_a_get_sigma_X
-    verify_my(&Q, &yQ, omega, omega_len, &y_ni);
-    verify_sigma_Y_1(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
-    ake_a_get_sigma_X(priv_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
+    verify_my(&Q, &session.yQ, omega, omega_len, &session.y_ni);
+    verify_sigma_Y_1(&pk_B, &session, sigma_Y_1);
+    ake_a_get_sigma_X(&sk_A, &session, sigma_Y_1, sigma_X);
     total_time_A += time_verify_my + time_verify_sigma_Y_1 + time_ake_a_get_sigma_X;
 
     // Mesure verify_sigma_X
     printf("verify_sigma_X : \n");
-    double time_verify_sigma_X = mesure_verify_sigma_X(pub_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len, nb_trials);
+    double time_verify_sigma_X = mesure_verify_sigma_X(&pk_A, &session, sigma_Y_1, sigma_X, nb_trials);
  
     // O : verify_sigma_X
-    verify_sigma_X(pub_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
+    verify_sigma_X(&pk_A, &session, sigma_Y_1, sigma_X);
     total_time_O += time_verify_sigma_X;
 
     // Mesure ake_b_get_sigma_Y_2
     printf("ake_b_get_sigma_Y_2 : \n");
-    double time_ake_b_get_sigma_Y_2 = mesure_ake_b_get_sigma_Y_2(priv_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, nb_trials);
+    double time_ake_b_get_sigma_Y_2 = mesure_ake_b_get_sigma_Y_2(&sk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2, nb_trials);
     
     // B : verify_sigma_X, ake_b_get_sigma_Y_2
-    verify_sigma_X(pub_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
-    ake_b_get_sigma_Y_2(priv_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
+    verify_sigma_X(&pk_A, &session, sigma_Y_1, sigma_X);
+    ake_b_get_sigma_Y_2(&sk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2);
     total_time_B += time_verify_sigma_X + time_ake_b_get_sigma_Y_2;
 
     // Mesure ake_a_get_shared_key
     printf("ake_a_get_shared_key : \n");
-    double time_ake_a_get_shared_key = mesure_ake_a_get_shared_key(&L_pk, &yQ, &x, &ka, nb_trials);
+    double time_ake_a_get_shared_key = mesure_ake_a_get_shared_key(&L_pk, &session, &x, &ka, nb_trials);
 
     // A : ake_a_get_shared_key
-    ake_a_get_shared_key(&L_pk, &yQ, &x, &ka);
+    ake_a_get_shared_key(&L_pk, &session, &x, &ka);
     total_time_A += time_ake_a_get_shared_key;
 
     // Mesure ake_b_get_shared_key
     printf("ake_b_get_shared_key : \n");
-    double time_ake_b_get_shared_key = mesure_ake_b_get_shared_key(&L_pk, &xQ, &y, &kb, nb_trials);
+    double time_ake_b_get_shared_key = mesure_ake_b_get_shared_key(&L_pk, &session, &y, &kb, nb_trials);
 
     // B : ake_b_get_shared_key
-    ake_b_get_shared_key(&L_pk, &xQ, &y, &kb);
+    ake_b_get_shared_key(&L_pk, &session, &y, &kb);
     total_time_B += time_ake_b_get_shared_key;
 
     // Mesure ake_b_get_sigma_Y_2
     printf("verify_sigma_Y_2 : \n");
-    double time_verify_sigma_Y_2 = mesure_verify_sigma_Y_2(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, nb_trials);
+    double time_verify_sigma_Y_2 = mesure_verify_sigma_Y_2(&pk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2, nb_trials);
   
     // Mesure ake_O_get_sst
     printf("ake_O_get_sst : \n");
-    double time_ake_O_get_sst = mesure_ake_O_get_sst(priv_key_O, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, &sst, nb_trials);
+    double time_ake_O_get_sst = mesure_ake_O_get_sst(&sk_O, &session, sigma_Y_1, sigma_X, sigma_Y_2, &sst, nb_trials);
   
     // O : verify_sigma_Y_2, ake_O_get_sst
-    verify_sigma_Y_2(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
-    ake_O_get_sst(priv_key_O, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, &sst);
+    verify_sigma_Y_2(&pk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2);
+    ake_O_get_sst(&sk_O, &session, sigma_Y_1, sigma_X, sigma_Y_2, &sst);
     total_time_O += time_verify_sigma_Y_2 + time_ake_O_get_sst;
 
     // Mesure verify_sst
     printf("verify_sst : \n");
-    double time_verify_sst = mesure_verify_sst(pub_key_O, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, &sst, nb_trials);
+    double time_verify_sst = mesure_verify_sst(&pk_O, &session, sigma_Y_1, sigma_X, sigma_Y_2, &sst, nb_trials);
 
     // Mesure verify_L_ni
     printf("verify_L_ni (2 Authorities) : \n");
-    double time_verify_L_ni = mesure_verify_L_ni_for_2L(&P, &L1_pk, &l1_ni, &L2_pk, &l2_ni, nb_trials);
+    double time_verify_L_ni = mesure_verify_L_ni(&P, nb_authorities, Li_pk, li_ni, nb_trials);
 
     // Verification
-    verify_L_ni(&P, 4, &L1_pk, &l1_ni, &L2_pk, &l2_ni);
-    verify_mx(&P, &xP, &Q, &xQ, omega, omega_len, &x_ni);
-    verify_my(&Q, &yQ, omega, omega_len, &y_ni);
-    verify_sigma_Y_1(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sig_len);
-    verify_sigma_X(pub_key_A, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sig_len);
-    verify_sigma_Y_2(pub_key_B, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len);
-    verify_sst(pub_key_O, omega, omega_len, &xP, &xQ, &x_ni, &yQ, &y_ni, sigma_Y_1, sigma_X, sigma_Y_2, sig_len, &sst);
+    verify_L_ni(&P, nb_authorities, Li_pk, li_ni);
+    verify_mx(&P, &Q, &session, NULL);
+    verify_my(&Q, &session.yQ, omega, omega_len, &session.y_ni);
+    verify_sigma_Y_1(&pk_B, &session, sigma_Y_1);
+    verify_sigma_X(&pk_A, &session, sigma_Y_1, sigma_X);
+    verify_sigma_Y_2(&pk_B, &session, sigma_Y_1, sigma_X, sigma_Y_2);
+    verify_sst(&pk_O, &session, sigma_Y_1, sigma_X, sigma_Y_2, &sst);
     total_time_Ver += time_verify_L_ni + time_verify_mx + time_verify_my + time_verify_sigma_Y_1 + time_verify_sigma_X + time_verify_sigma_Y_2 + time_verify_sst;
 
     // Mesure tdgen_get_li_T1
     printf("tdgen_get_li_T1 (2 Authorities) : \n");
-    double time_tdgen_get_li_T1_for_2L = mesure_tdgen_get_li_T1_for_2L(&xP, &yQ, &l1_sk, &l1_T1, &l2_sk, &l2_T1, nb_trials);
+    double time_tdgen_get_li_T1_for_2L = mesure_tdgen_get_li_T1(&session, nb_authorities, li_sk, li_T1, nb_trials);
 
     // Mesure tdgen_get_li_T2
     printf("tdgen_get_li_T2 (2 Authorities) : \n");
-    double time_tdgen_get_li_T2_for_2L = mesure_tdgen_get_li_T2_for_2L(&P, &xP, &yQ, &L1_pk, &l1_sk, &l1_T1, &l1_T2, &L2_pk, &l2_sk, &l2_T1, &l2_T2, nb_trials);
+    double time_tdgen_get_li_T2_for_2L = mesure_tdgen_get_li_T2(&P, &session, nb_authorities, Li_pk, li_sk, li_T1, li_T2, nb_trials);
 
     // TDGen
-    tdgen_get_li_T1(&xP, &yQ, 4, &l1_sk, &l1_T1, &l2_sk, &l2_T1);
-    tdgen_get_li_T2(&P, &xP, &yQ, 8, &L1_pk, &l1_sk, &l1_T1, &l1_T2, &L2_pk, &l2_sk, &l2_T1, &l2_T2);
+    tdgen_get_li_T1(&session, nb_authorities, li_sk, li_T1);
+    tdgen_get_li_T2(&P, &session, nb_authorities, Li_pk, li_sk, li_T1, li_T2);
     total_time_TDGen += time_tdgen_get_li_T1_for_2L + time_tdgen_get_li_T2_for_2L;
     
     // Mesure verify_li_T2
     printf("verify_li_T2 (2 Authorities) : \n");
-    double time_verify_li_T2_for_2 = mesure_verify_li_T2_for_2L(&P, &xP, &yQ, &L1_pk, &l1_T1, &l1_T2, &L2_pk, &l2_T1, &l2_T2, nb_trials);
+    double time_verify_li_T2_for_2 = mesure_verify_li_T2(&P, &session, nb_authorities, Li_pk, li_T1, li_T2, nb_trials);
 
     // Mesure open_get_shared_key
     printf("open_get_shared_key (2 Authorities) : \n");
-    double time_open_get_shared_key_for_2 = mesure_open_get_shared_key_for_2(&k, &l1_T1, &l2_T1, nb_trials);
+    double time_open_get_shared_key_for_2 = mesure_open_get_shared_key(&k, nb_authorities, li_T1, nb_trials);
     
     // Open
-    verify_li_T2(&P, &xP, &yQ, 6, &L1_pk, &l1_T1, &l1_T2, &L2_pk, &l2_T1, &l2_T2);
-    open_get_shared_key(&k, 2, &l1_T1, &l2_T1);
+    verify_li_T2(&P, &session, nb_authorities, Li_pk, li_T1, li_T2);
+    open_get_shared_key(&k, nb_authorities, li_T1);
     total_time_Open += time_verify_li_T2_for_2 + time_open_get_shared_key_for_2;
 
+    // Mesure TDGen and Open with one e(xP, yQ) per authority against the session cache
+    double time_saved_TDGen, time_saved_Open;
+    mesure_xy_pairing_cache(&P, &session, nb_authorities, Li_pk, li_sk, li_T2, &time_saved_TDGen, &time_saved_Open, nb_trials);
+
     // Check key
     int res = mclBnGT_isEqual(&ka, &kb);
     if(res != 1)
@@ -904,18 +2187,44 @@ int main(int argc, char *argv[])
         printf("Keys not equal\n");
     }
 
+    // Shared key derivation with the scalar in G1 against the GT exponentiation
+    mesure_shared_key_paths(&L_pk, &session, &x, &y, nb_trials);
+
+    // Lines of xQ computed by verify_mx and reused for kb against a plain Miller loop for each pairing
+    mesure_xQ_lines(&P, &Q, &L_pk, &session, &y, nb_trials);
+
+    // Operator checks ordered by cost against the former order, on valid and forged messages
+    mesure_operator_checks(&P, &Q, &pk_B, &session, sigma_Y_1, nb_trials);
+
+    // Offline/online split of mx and my with pools of precomputed ephemerals
+    mesure_pool(&P, &Q, omega, omega_len, nb_trials);
+
+    // Authorities functions up to 1024 authorities
+    mesure_authorities(&P, &session, nb_trials);
+
+    // Signing modes of the AKE messages against the size of omega
+    mesure_sig_modes(&sk_B, &pk_B, &session, nb_trials);
+
     printf("Total CPU running time for A : %f\n", total_time_A);
     printf("Total CPU running time for B : %f\n", total_time_B);
     printf("Total CPU running time for O : %f\n", total_time_O);
     printf("Total CPU running time for Verification : %f\n", total_time_Ver);
-    printf("Total CPU running time for TDGen (2 Authorities) : %f\n", total_time_TDGen);
-    printf("Total CPU running time for Open (2 Authorities) : %f\n", total_time_Open);
+    printf("Total CPU running time for TDGen (2 Authorities) : %f (%f saved by the session e(xP, yQ) cache)\n", total_time_TDGen, time_saved_TDGen);
+    printf("Total CPU running time for Open (2 Authorities) : %f (%f saved by the session e(xP, yQ) cache)\n", total_time_Open, time_saved_Open);
 
     free(sigma_Y_1);
     free(sigma_X);
     free(sigma_Y_2);
     free(sst.m);
     free(sst.sigma_O);
+    like_session_free(&session);
+    aggregate_key_free(&L_pk);
+    ed25519_key_free(&sk_A);
+    ed25519_key_free(&pk_A);
+    ed25519_key_free(&sk_B);
+    ed25519_key_free(&pk_B);
+    ed25519_key_free(&sk_O);
+    ed25519_key_free(&pk_O);
 
     return 0;
 